@@ -7,6 +7,39 @@ namespace cndetails {
 // inside the following template environments. This helper method emulates the required member function.
 template<typename T, int N>
 const ei::Vec<T, N-1> & prefix(const ei::Vec<T,N> & _v) { return *reinterpret_cast<const ei::Vec<T, N-1> &>(&_v); }
+
+// Generators which hash all coordinates of a lattice point at once (see
+// LatticeHash in rnd.hpp). The fields use a flat loop over all corners of
+// a cell for them instead of the per-dimension hash chain.
+template<typename RndGen, int N> struct IsLatticeHash : std::false_type {};
+template<int N> struct IsLatticeHash<LatticeHash<N>, N> : std::true_type {};
+template<int N> struct IsLatticeHash<const LatticeHash<N>, N> : std::true_type {};
+
+// Lower and upper (periodic) lattice coordinates of the cell containing
+// _x * _frequency and the position within the cell.
+template<int N>
+void latticeCell(const ei::Vec<float,N>& _x, const ei::Vec<int,N>& _frequency, ei::Vec<int,N>& _lo, ei::Vec<int,N>& _hi, ei::Vec<float,N>& _f)
+{
+    for(int d = 0; d < N; ++d)
+    {
+        float x = _x[d] * _frequency[d];
+        int ix = ei::floor(x);
+        _f[d] = x - ix;
+        _lo[d] = ei::mod(ix, _frequency[d]);
+        _hi[d] = _lo[d] + 1 == _frequency[d] ? 0 : _lo[d] + 1;
+    }
+}
+
+// Multilinear interpolation of the 2^N corner values (bit d of the index
+// is the offset in dimension d). Overwrites _v.
+template<int N>
+float multilerp(float* _v, const ei::Vec<float,N>& _f)
+{
+    for(int d = N-1; d >= 0; --d)
+        for(int c = 0; c < (1 << d); ++c)
+            _v[c] = ei::lerp(_v[c], _v[c + (1 << d)], _f[d]);
+    return _v[0];
+}
 } // namespace cndetails
 
 // Recursion end
@@ -16,11 +49,11 @@ float valueNoise(RndGen& _generator, ei::Vec<float,0> _x, ei::Vec<int,0> _freque
     return (_generator(_seed) & 0x00ffffff) / 16777215.0f;
 }
 
-// Recursion step
+namespace cndetails {
+// Recursion step: one hash per dimension, chained
 template<typename RndGen, int N>
-float valueNoise(RndGen& _generator, const ei::Vec<float,N>& _x, const ei::Vec<int,N>& _frequency, Interpolation _interp, uint32 _seed)
+float valueNoiseImpl(RndGen& _generator, const ei::Vec<float,N>& _x, const ei::Vec<int,N>& _frequency, Interpolation _interp, uint32 _seed, std::false_type)
 {
-    using namespace cndetails;
     float x = _x[N-1] * _frequency[N-1];
     int ix = ei::floor(x);
     switch(_interp)
@@ -43,6 +76,43 @@ float valueNoise(RndGen& _generator, const ei::Vec<float,N>& _x, const ei::Vec<i
     return 0.0f;
 }
 
+// All corners from one lattice hash
+template<typename RndGen, int N>
+float valueNoiseImpl(RndGen& _hash, const ei::Vec<float,N>& _x, const ei::Vec<int,N>& _frequency, Interpolation _interp, uint32 _seed, std::true_type)
+{
+    ei::Vec<int,N> lo, hi;
+    ei::Vec<float,N> f;
+    latticeCell<N>(_x, _frequency, lo, hi, f);
+    switch(_interp)
+    {
+    case cn::Interpolation::POINT:
+        return (_hash(_seed, lo) & 0x00ffffff) / 16777215.0f;
+    case cn::Interpolation::LINEAR:
+    case cn::Interpolation::SMOOTHSTEP:
+    case cn::Interpolation::SMOOTHERSTEP: {
+        for(int d = 0; d < N; ++d)
+        {
+            if(_interp == cn::Interpolation::SMOOTHSTEP) f[d] = ei::smoothstep(f[d]);
+            else if(_interp == cn::Interpolation::SMOOTHERSTEP) f[d] = ei::smootherstep(f[d]);
+        }
+        uint32 h[1 << N];
+        float v[1 << N];
+        _hash.corners(_seed, lo, hi, h);
+        for(int c = 0; c < (1 << N); ++c)
+            v[c] = (h[c] & 0x00ffffff) / 16777215.0f;
+        return multilerp<N>(v, f);
+    }
+    }
+    return 0.0f;
+}
+} // namespace cndetails
+
+template<typename RndGen, int N>
+float valueNoise(RndGen& _generator, const ei::Vec<float,N>& _x, const ei::Vec<int,N>& _frequency, Interpolation _interp, uint32 _seed)
+{
+    return cndetails::valueNoiseImpl<RndGen, N>(_generator, _x, _frequency, _interp, _seed, cndetails::IsLatticeHash<RndGen, N>());
+}
+
 
 namespace cndetails {
 
@@ -197,6 +267,89 @@ namespace cndetails {
         float s1 = perlinNoiseRecG<RndGen, N+1, NMAX>(_generator, _toGrid, _ix, _frequency, _f, _df, _generator(_seed ^ _ix[N]), _gradient, wa);
         return w0 * s0 + w1 * s1;
     }
+
+    // Evaluate the cell with the hash chain.
+    template<typename RndGen, int N>
+    float perlinNoiseCell(RndGen& _generator, const ei::Vec<float,N>& _toGrid, const ei::Vec<int,N>& _ix, const ei::Vec<int,N>& _frequency, const ei::Vec<float,N>& _f, Interpolation _interp, uint32 _seed, std::false_type)
+    {
+        if(_interp == cn::Interpolation::POINT)
+            return perlinNoiseRec<RndGen, 0, N>(_generator, _toGrid, _ix, _seed);
+        else
+            return perlinNoiseRec<RndGen, 0, N>(_generator, _toGrid, _ix, _frequency, _f, _seed) * 0.5f + 0.5f;
+    }
+
+    // Evaluate the cell with all corner hashes at once.
+    template<typename RndGen, int N>
+    float perlinNoiseCell(RndGen& _hash, const ei::Vec<float,N>& _toGrid, const ei::Vec<int,N>& _ix, const ei::Vec<int,N>& _frequency, const ei::Vec<float,N>& _f, Interpolation _interp, uint32 _seed, std::true_type)
+    {
+        if(_interp == cn::Interpolation::POINT)
+            return dotGrad(_toGrid, _hash(_seed, _ix));
+        ei::Vec<int,N> hi;
+        for(int d = 0; d < N; ++d) hi[d] = _ix[d] + 1 == _frequency[d] ? 0 : _ix[d] + 1;
+        uint32 h[1 << N];
+        float v[1 << N];
+        _hash.corners(_seed, _ix, hi, h);
+        for(int c = 0; c < (1 << N); ++c)
+        {
+            ei::Vec<float,N> toGrid = _toGrid;
+            for(int d = 0; d < N; ++d)
+                if(c & (1 << d)) toGrid[d] += 1.0f;
+            v[c] = dotGrad(toGrid, h[c]);
+        }
+        return multilerp<N>(v, _f) * 0.5f + 0.5f;
+    }
+
+    template<typename RndGen, int N>
+    float perlinNoiseCellG(RndGen& _generator, const ei::Vec<float,N>& _toGrid, const ei::Vec<int,N>& _ix, const ei::Vec<int,N>& _frequency, const ei::Vec<float,N>& _f, const ei::Vec<float,N>& _df, Interpolation _interp, uint32 _seed, ei::Vec<float,N>& _gradient, std::false_type)
+    {
+        if(_interp == cn::Interpolation::POINT) {
+            return perlinNoiseRec<RndGen, 0, N>(_generator, _toGrid, _ix, _seed);
+        } else {
+            ei::Vec<float, N> wa(1.0f);
+            return perlinNoiseRecG<RndGen, 0, N>(_generator, _toGrid, _ix, _frequency, _f, _df, _seed, _gradient, wa) * 0.5f + 0.5f;
+        }
+    }
+
+    // Same accumulation of the gradient as perlinNoiseRecG, but as flat loop
+    // over the corners.
+    template<typename RndGen, int N>
+    float perlinNoiseCellG(RndGen& _hash, const ei::Vec<float,N>& _toGrid, const ei::Vec<int,N>& _ix, const ei::Vec<int,N>& _frequency, const ei::Vec<float,N>& _f, const ei::Vec<float,N>& _df, Interpolation _interp, uint32 _seed, ei::Vec<float,N>& _gradient, std::true_type)
+    {
+        if(_interp == cn::Interpolation::POINT)
+            return dotGrad(_toGrid, _hash(_seed, _ix));
+        ei::Vec<int,N> hi;
+        for(int d = 0; d < N; ++d) hi[d] = _ix[d] + 1 == _frequency[d] ? 0 : _ix[d] + 1;
+        uint32 h[1 << N];
+        _hash.corners(_seed, _ix, hi, h);
+        float sum = 0.0f;
+        for(int c = 0; c < (1 << N); ++c)
+        {
+            ei::Vec<float,N> toGrid = _toGrid;
+            ei::Vec<float,N> w;
+            for(int d = 0; d < N; ++d)
+            {
+                bool upper = (c & (1 << d)) != 0;
+                if(upper) toGrid[d] += 1.0f;
+                w[d] = upper ? _f[d] : 1.0f - _f[d];
+            }
+            ei::Vec<float,N> g( grad(h[c], toGrid) );
+            float v = dot(toGrid, g);
+            float wAll = 1.0f;
+            for(int d = 0; d < N; ++d) wAll *= w[d];
+            for(int i = 0; i < N; ++i)
+            {
+                // Product of all weights except dimension i
+                float wa = 1.0f;
+                for(int d = 0; d < N; ++d) if(d != i) wa *= w[d];
+                if(c & (1 << i))
+                    _gradient[i] += (v * _df[i] - g[i] * _f[i]) * wa;
+                else
+                    _gradient[i] -= (v * _df[i] + g[i] * (1.0f - _f[i])) * wa;
+            }
+            sum += wAll * v;
+        }
+        return sum * 0.5f + 0.5f;
+    }
 }
 
 template<typename RndGen, int N>
@@ -220,10 +373,7 @@ float perlinNoise(RndGen& _generator, ei::Vec<float,N> _x, const ei::Vec<int,N>&
             for(int i = 0; i < N; ++i) f[i] = 0.5f - 0.5f * cos(f[i]);
             break;
     }
-    if(_interp == cn::Interpolation::POINT)
-        return cndetails::perlinNoiseRec<RndGen, 0, N>(_generator, _x, ix, _seed);
-    else
-        return cndetails::perlinNoiseRec<RndGen, 0, N>(_generator, _x, ix, _frequency, f, _seed) * 0.5f + 0.5f;
+    return cndetails::perlinNoiseCell<RndGen, N>(_generator, _x, ix, _frequency, f, _interp, _seed, cndetails::IsLatticeHash<RndGen, N>());
 }
 
 template<typename RndGen, int N>
@@ -258,12 +408,7 @@ float perlinNoiseG(RndGen& _generator, ei::Vec<float,N> _x, const ei::Vec<int,N>
             }
             break;
     }
-    if(_interp == cn::Interpolation::POINT) {
-        return cndetails::perlinNoiseRec<RndGen, 0, N>(_generator, _x, ix, _seed);
-    } else {
-        ei::Vec<float, N> wa(1.0f);
-        return cndetails::perlinNoiseRecG<RndGen, 0, N>(_generator, _x, ix, _frequency, f, df, _seed, _gradient, wa) * 0.5f + 0.5f;
-    }
+    return cndetails::perlinNoiseCellG<RndGen, N>(_generator, _x, ix, _frequency, f, df, _interp, _seed, _gradient, cndetails::IsLatticeHash<RndGen, N>());
 }
 
 
@@ -0,0 +1,103 @@
+template<typename Gen, size_t BlockSize>
+BufferedRng<Gen, BlockSize>::BufferedRng(const Gen& _generator) :
+    position(BlockSize), // Fill on first use
+    generator(_generator)
+{
+    static_assert(BlockSize > 0, "BufferedRng requires a non-empty buffer.");
+}
+
+template<typename Gen, size_t BlockSize>
+inline ei::uint32 BufferedRng<Gen, BlockSize>::operator () ()
+{
+    if(position == BlockSize)
+    {
+        generator.fill(buffer, BlockSize);
+        position = 0;
+    }
+    return buffer[position++];
+}
+
+template<typename Gen, size_t BlockSize>
+void BufferedRng<Gen, BlockSize>::fill(ei::uint32* _out, size_t _n)
+{
+    // Use up the buffered numbers, the remainder directly comes from the
+    // generator.
+    size_t m = BlockSize - position;
+    if(m > _n) m = _n;
+    for(size_t i = 0; i < m; ++i)
+        _out[i] = buffer[position + i];
+    position += m;
+    if(_n > m)
+        generator.fill(_out + m, _n - m);
+}
+
+template<typename Gen, size_t BlockSize>
+void BufferedRng<Gen, BlockSize>::fill(ei::uint64* _out, size_t _n)
+{
+    for(size_t i = 0; i < _n; ++i)
+    {
+        ei::uint64 x = ei::uint64((*this)()) << 32;
+        _out[i] = x | (*this)();
+    }
+}
+
+
+
+template<int N>
+const ei::uint32 LatticeHash<N>::MULTIPLIERS[4] = {0x8da6b343u, 0xd8163841u, 0xcb1ab31fu, 0x9e3779b1u};
+
+namespace details {
+    // Finalizer of ProspectorHash
+    inline ei::uint32 latticeFinalize(ei::uint32 _x)
+    {
+        _x ^= _x >> 16;
+        _x *= 0x7feb352du;
+        _x ^= _x >> 15;
+        _x *= 0x846ca68bu;
+        _x ^= _x >> 16;
+        return _x;
+    }
+}
+
+template<int N>
+inline ei::uint32 LatticeHash<N>::operator () (ei::uint32 _seed, const ei::Vec<int, N>& _p) const
+{
+    static_assert(N >= 2 && N <= 4, "LatticeHash is defined for 2 to 4 dimensions.");
+    ei::uint32 h = 0;
+    for(int d = 0; d < N; ++d)
+        h += ei::uint32(_p[d]) * MULTIPLIERS[d];
+    return details::latticeFinalize(h ^ _seed);
+}
+
+template<int N>
+inline void LatticeHash<N>::corners(ei::uint32 _seed, const ei::Vec<int, N>& _lo, const ei::Vec<int, N>& _hi, ei::uint32* _out) const
+{
+    static_assert(N >= 2 && N <= 4, "LatticeHash is defined for 2 to 4 dimensions.");
+    ei::uint32 term[N][2];
+    for(int d = 0; d < N; ++d)
+    {
+        term[d][0] = ei::uint32(_lo[d]) * MULTIPLIERS[d];
+        term[d][1] = ei::uint32(_hi[d]) * MULTIPLIERS[d];
+    }
+    for(int c = 0; c < (1 << N); ++c)
+    {
+        ei::uint32 h = 0;
+        for(int d = 0; d < N; ++d)
+            h += term[d][(c >> d) & 1];
+        _out[c] = details::latticeFinalize(h ^ _seed);
+    }
+}
+
+template<typename T>
+StreamHash& StreamHash::update(const T& _value)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "StreamHash::update requires a trivially copyable type.");
+    static_assert(!std::is_pointer<T>::value, "Hashing a pointer value is probably a mistake. Use update(data, size) for the memory it points to.");
+    return update(&_value, sizeof(T));
+}
+
+template<typename Container>
+auto seedFrom(const Container& _key, ei::uint32 _salt) -> decltype(_key.data(), _key.size(), ei::uint64())
+{
+    return seedFrom(_key.data(), _key.size() * sizeof(*_key.data()), _salt);
+}
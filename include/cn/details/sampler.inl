@@ -50,34 +50,348 @@ inline  float uniform(uint32 _rnd, float _min, float _max)
 
 
 
-inline float gaussian(uint32 _rnd0, uint32 _rnd1)
+namespace details {
+    // Draw 64 random bits: natively from 64 bit generators (next64()),
+    // otherwise from two consecutive numbers.
+    template<typename RndGen>
+    auto draw64(RndGen& _generator, int) -> decltype(uint64(_generator.next64()))
+    {
+        return _generator.next64();
+    }
+
+    template<typename RndGen>
+    uint64 draw64(RndGen& _generator, long)
+    {
+        uint64 x = uint64(_generator()) << 32;
+        return x | _generator();
+    }
+}
+
+namespace details {
+    // Full 64x64 -> 128 bit product.
+    inline void mulWide(uint64 _a, uint64 _b, uint64& _hi, uint64& _lo)
+    {
+#ifdef __SIZEOF_INT128__
+        unsigned __int128 p = (unsigned __int128)_a * _b;
+        _hi = uint64(p >> 64);
+        _lo = uint64(p);
+#else
+        uint64 a0 = _a & 0xffffffff, a1 = _a >> 32;
+        uint64 b0 = _b & 0xffffffff, b1 = _b >> 32;
+        uint64 p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+        uint64 mid = (p00 >> 32) + (p01 & 0xffffffff) + (p10 & 0xffffffff);
+        _lo = (mid << 32) | (p00 & 0xffffffff);
+        _hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+#endif
+    }
+
+    // Lemire's method: the upper half of x * _range is uniform in
+    // [0, _range[ if x is rejected whenever the lower half is below
+    // 2^32 mod _range. The threshold is only computed if the lower half is
+    // below _range.
+    template<typename RndGen>
+    uint32 boundedInt(RndGen& _generator, uint32 _range, std::false_type)
+    {
+        uint64 m = uint64(_generator()) * _range;
+        if(uint32(m) < _range)
+        {
+            uint32 threshold = (0u - _range) % _range;
+            while(uint32(m) < threshold)
+                m = uint64(_generator()) * _range;
+        }
+        return uint32(m >> 32);
+    }
+
+    template<typename RndGen>
+    uint64 boundedInt(RndGen& _generator, uint64 _range, std::true_type)
+    {
+        uint64 hi, lo;
+        mulWide(draw64(_generator, 0), _range, hi, lo);
+        if(lo < _range)
+        {
+            uint64 threshold = (0ull - _range) % _range;
+            while(lo < threshold)
+                mulWide(draw64(_generator, 0), _range, hi, lo);
+        }
+        return hi;
+    }
+}
+
+template<typename RndGen, typename T>
+T uniformInt(RndGen& _generator, T _min, T _max)
 {
-    // Box muller method.
-    double u0 = _rnd0 / 4294967295.0;
-    double u1 = _rnd1 / 4294967295.0;
-    double R = sqrt(ei::max(0.0, -2.0*log(u0 + 1.0e-323)));
-    return float(R * cos(6.283185307179586476925286766559 * u1));
+    static_assert(std::is_integral<T>::value, "uniformInt() requires an integer type.");
+    typedef std::integral_constant<bool, (sizeof(T) > 4)> IsWide;
+    typedef typename std::conditional<IsWide::value, uint64, uint32>::type U;
+    // Number of values (wraps to 0 for the full range)
+    U range = U(U(_max) - U(_min) + 1);
+    if(range == 0)
+        return T(IsWide::value ? U(details::draw64(_generator, 0)) : U(_generator()));
+    return T(U(_min) + details::boundedInt(_generator, range, IsWide()));
 }
 
 template<typename RndGen>
-float gaussian(RndGen& _generator) { return gaussian(_generator(), _generator()); }
+double uniformDouble(RndGen& _generator)
+{
+    return uniformDouble(details::draw64(_generator, 0));
+}
+
+inline double uniformDouble(uint64 _rnd)
+{
+    // The upper 53 bits are exactly representable, the scale is a power of two.
+    return (_rnd >> 11) * (1.0 / 9007199254740992.0);
+}
+
+template<typename RndGen>
+double uniformDouble(RndGen& _generator, double _min, double _max)
+{
+    return uniformDouble(_generator) * (_max - _min) + _min;
+}
 
 
 
-inline float gaussian(uint32 _rnd0, uint32 _rnd1, float _sigma, float _mu)
+template<uint N>
+ei::Vec<float, N> uniform(ei::Vec<uint32, N> _rnd)
 {
-    double u0 = _rnd0 / 4294967295.0;
-    double u1 = _rnd1 / 4294967295.0;
-    double R = sqrt(ei::max(0.0, -2.0*log(u0 + 1.0e-323)));
-    return float(_mu + _sigma * R * cos(6.283185307179586476925286766559 * u1));
+    ei::Vec<float, N> res;
+    for(uint i = 0; i < N; ++i) res[i] = uniform(_rnd[i]);
+    return res;
 }
 
-template<typename RndGen>
-float gaussian(RndGen& _generator, float _sigma, float _mu) { return gaussian(_generator(), _generator(), _sigma, _mu); }
+template<uint N>
+ei::Vec<float, N> uniformEx(ei::Vec<uint32, N> _rnd)
+{
+    ei::Vec<float, N> res;
+    for(uint i = 0; i < N; ++i) res[i] = uniformEx(_rnd[i]);
+    return res;
+}
+
+template<uint N>
+ei::Vec<float, N> uniform(ei::Vec<uint32, N> _rnd, float _min, float _max)
+{
+    ei::Vec<float, N> res;
+    for(uint i = 0; i < N; ++i) res[i] = uniform(_rnd[i], _min, _max);
+    return res;
+}
+
+
+
+namespace details {
+    inline float asFloat(uint32 _x) { float f; std::memcpy(&f, &_x, 4); return f; }
+    inline uint32 asUInt(float _x) { uint32 i; std::memcpy(&i, &_x, 4); return i; }
+
+    // Scalar version of the SIMD wrappers in sampler.cpp. The polynomials
+    // below are written once for all of them, so the single sample functions
+    // and the SIMD kernels give the same results. F is a vector of W floats
+    // and I a vector of W 32 bit integers.
+    struct ScalarFloatOps
+    {
+        typedef float F;
+        typedef uint32 I;
+        enum { W = 1 };
+        static I load(const uint32* _p) { return *_p; }
+        static F loadF(const float* _p) { return *_p; }
+        static void store(float* _p, F _x) { *_p = _x; }
+        static F splat(float _x) { return _x; }
+        static I splatI(uint32 _x) { return _x; }
+        static F add(F _a, F _b) { return _a + _b; }
+        static F sub(F _a, F _b) { return _a - _b; }
+        static F mul(F _a, F _b) { return _a * _b; }
+        static F div(F _a, F _b) { return _a / _b; }
+        static F max(F _a, F _b) { return _a > _b ? _a : _b; }
+        static F sqrt(F _x) { return std::sqrt(_x); }
+        static I addI(I _a, I _b) { return _a + _b; }
+        static I andI(I _a, I _b) { return _a & _b; }
+        static I orI(I _a, I _b) { return _a | _b; }
+        static I xorI(I _a, I _b) { return _a ^ _b; }
+        template<int K> static I shl(I _x) { return _x << K; }
+        template<int K> static I shr(I _x) { return _x >> K; }
+        template<int K> static I sra(I _x) { return I(int32(_x) >> K); }
+        static F asF(I _x) { return asFloat(_x); }
+        static I asI(F _x) { return asUInt(_x); }
+        static F cvt(I _x) { return float(int32(_x)); }
+        static I trunc(F _x) { return I(int32(_x)); }
+        static I greater(F _a, F _b) { return 0u - I(_a > _b); }
+        static F select(I _mask, F _a, F _b) { return asF((_mask & asI(_a)) | (~_mask & asI(_b))); }
+    };
+
+    // Natural logarithm for positive normalized numbers (polynomial from the
+    // Cephes library, max. relative error ~1e-7).
+    template<typename Ops>
+    typename Ops::F fastLog(const typename Ops::F& _x)
+    {
+        typedef typename Ops::F F;
+        typename Ops::I bits = Ops::asI(_x);
+        F e = Ops::sub(Ops::cvt(Ops::template shr<23>(bits)), Ops::splat(127.0f));
+        F m = Ops::asF(Ops::orI(Ops::andI(bits, Ops::splatI(0x007fffffu)), Ops::splatI(0x3f800000u)));
+        // Map the mantissa to [sqrt(0.5), sqrt(2)[ (with a select instead of
+        // a branch, which would be mispredicted half of the time)
+        typename Ops::I big = Ops::greater(m, Ops::splat(1.41421356f));
+        m = Ops::select(big, Ops::mul(m, Ops::splat(0.5f)), m);
+        e = Ops::add(e, Ops::asF(Ops::andI(big, Ops::splatI(0x3f800000u))));
+        F x = Ops::sub(m, Ops::splat(1.0f));
+        F z = Ops::mul(x, x);
+        F y = Ops::splat(7.0376836292e-2f);
+        y = Ops::add(Ops::mul(y, x), Ops::splat(-1.1514610310e-1f));
+        y = Ops::add(Ops::mul(y, x), Ops::splat(1.1676998740e-1f));
+        y = Ops::add(Ops::mul(y, x), Ops::splat(-1.2420140846e-1f));
+        y = Ops::add(Ops::mul(y, x), Ops::splat(1.4249322787e-1f));
+        y = Ops::add(Ops::mul(y, x), Ops::splat(-1.6668057665e-1f));
+        y = Ops::add(Ops::mul(y, x), Ops::splat(2.0000714765e-1f));
+        y = Ops::add(Ops::mul(y, x), Ops::splat(-2.4999993993e-1f));
+        y = Ops::add(Ops::mul(y, x), Ops::splat(3.3333331174e-1f));
+        y = Ops::mul(Ops::mul(y, x), z);
+        y = Ops::add(y, Ops::mul(e, Ops::splat(-2.12194440e-4f)));
+        y = Ops::sub(y, Ops::mul(z, Ops::splat(0.5f)));
+        x = Ops::add(x, y);
+        return Ops::add(x, Ops::mul(e, Ops::splat(0.693359375f)));
+    }
+
+    inline float fastLog(float _x) { return fastLog<ScalarFloatOps>(_x); }
+
+    // 2^_x for _x in [-126, 127] (clamped).
+    inline float fastExp2(float _x)
+    {
+        _x = ei::max(-126.0f, ei::min(127.0f, _x));
+        // Round to nearest (the argument of the truncation is positive)
+        int32 n = int32(_x + 127.5f) - 127;
+        float f = _x - float(n);
+        float p = 1.535336188319500e-4f;
+        p = p * f + 1.339887440266574e-3f;
+        p = p * f + 9.618437357674640e-3f;
+        p = p * f + 5.550332471162809e-2f;
+        p = p * f + 2.402264791363012e-1f;
+        p = p * f + 6.931472028550421e-1f;
+        return (p * f + 1.0f) * asFloat(uint32(n + 127) << 23);
+    }
+
+    // _x^_y for _x >= 0.
+    inline float fastPow(float _x, float _y)
+    {
+        float r = fastExp2(_y * fastLog(_x) * 1.44269504f);
+        return _x > 0.0f ? r : 0.0f;
+    }
+
+    // sin(2 pi _u) and cos(2 pi _u) for _u in [0,1]. The range reduction is
+    // exact, because the angle is given in turns. The polynomials on
+    // [-pi/4, pi/4] are from the Cephes library.
+    template<typename Ops>
+    void fastSinCos2pi(const typename Ops::F& _u, typename Ops::F& _sin, typename Ops::F& _cos)
+    {
+        typedef typename Ops::F F;
+        typedef typename Ops::I I;
+        F t = Ops::mul(_u, Ops::splat(8.0f));
+        // Nearest even octant j in [0,8] and the quadrant j/2
+        I j = Ops::andI(Ops::addI(Ops::trunc(t), Ops::splatI(1)), Ops::splatI(~1u));
+        F a = Ops::mul(Ops::sub(t, Ops::cvt(j)), Ops::splat(0.78539816339744830962f));
+        I q = Ops::template shr<1>(j);
+        F z = Ops::mul(a, a);
+        F s = Ops::splat(-1.9515295891e-4f);
+        s = Ops::add(Ops::mul(s, z), Ops::splat(8.3321608736e-3f));
+        s = Ops::add(Ops::mul(s, z), Ops::splat(-1.6666654611e-1f));
+        s = Ops::add(Ops::mul(Ops::mul(s, z), a), a);
+        F c = Ops::splat(2.443315711809948e-5f);
+        c = Ops::add(Ops::mul(c, z), Ops::splat(-1.388731625493765e-3f));
+        c = Ops::add(Ops::mul(c, z), Ops::splat(4.166664568298827e-2f));
+        c = Ops::add(Ops::sub(Ops::mul(Ops::mul(c, z), z), Ops::mul(z, Ops::splat(0.5f))), Ops::splat(1.0f));
+        // Odd quadrants swap sine and cosine, the signs follow the quadrant
+        I swap = Ops::template sra<31>(Ops::template shl<31>(q));
+        F sinA = Ops::select(swap, c, s);
+        F cosA = Ops::select(swap, s, c);
+        I sinSign = Ops::template shl<30>(Ops::andI(q, Ops::splatI(2)));
+        I cosSign = Ops::template shl<30>(Ops::andI(Ops::addI(q, Ops::splatI(1)), Ops::splatI(2)));
+        _sin = Ops::asF(Ops::xorI(Ops::asI(sinA), sinSign));
+        _cos = Ops::asF(Ops::xorI(Ops::asI(cosA), cosSign));
+    }
+
+    inline void fastSinCos2pi(float _u, float& _sin, float& _cos) { fastSinCos2pi<ScalarFloatOps>(_u, _sin, _cos); }
+}
+
+// The Box-Muller and exponential transforms use the type Real and
+// uniform numbers in ]0,1] (uniformOpen) resp. [0,1] (uniform). The angles
+// are given in turns.
+struct Precise
+{
+    typedef double Real;
+    static double uniformOpen(uint32 _rnd) { return _rnd / 4294967295.0 + 1.0e-323; }
+    static double uniform(uint32 _rnd) { return _rnd / 4294967295.0; }
+    static double log(double _x) { return std::log(_x); }
+    static double pow(double _x, double _y) { return std::pow(_x, _y); }
+    static double cos2pi(double _u) { return std::cos(6.283185307179586476925286766559 * _u); }
+    static void sinCos2pi(double _u, double& _sin, double& _cos)
+    {
+        _u *= 6.283185307179586476925286766559;
+        _sin = std::sin(_u);
+        _cos = std::cos(_u);
+    }
+    // The direction samplers compute the angle in single precision.
+    static void sinCos2pi(float _u, double& _sin, double& _cos)
+    {
+        double phi = 2.0f * ei::PI * _u;
+        _sin = std::sin(phi);
+        _cos = std::cos(phi);
+    }
+};
+
+struct Fast
+{
+    typedef float Real;
+    static float uniformOpen(uint32 _rnd) { return _rnd * 2.32830644e-10f + 1.17549435e-38f; }
+    static float uniform(uint32 _rnd) { return _rnd * 2.32830644e-10f; }
+    static float log(float _x) { return details::fastLog(_x); }
+    static float pow(float _x, float _y) { return details::fastPow(_x, _y); }
+    static float cos2pi(float _u) { float s, c; details::fastSinCos2pi(_u, s, c); return c; }
+    static void sinCos2pi(float _u, float& _sin, float& _cos) { details::fastSinCos2pi(_u, _sin, _cos); }
+};
+
+
+
+template<typename Precision = Precise>
+float gaussian(uint32 _rnd0, uint32 _rnd1)
+{
+    // Box muller method.
+    typedef typename Precision::Real Real;
+    Real R = sqrt(ei::max(Real(0), Real(-2) * Precision::log(Precision::uniformOpen(_rnd0))));
+    return float(R * Precision::cos2pi(Precision::uniform(_rnd1)));
+}
+
+template<typename RndGen, typename Precision>
+float gaussian(RndGen& _generator) { return gaussian<Precision>(_generator(), _generator()); }
 
 
 
-template<typename RndGen, uint N>
+template<typename Precision = Precise>
+float gaussian(uint32 _rnd0, uint32 _rnd1, float _sigma, float _mu)
+{
+    typedef typename Precision::Real Real;
+    Real R = sqrt(ei::max(Real(0), Real(-2) * Precision::log(Precision::uniformOpen(_rnd0))));
+    return float(_mu + _sigma * R * Precision::cos2pi(Precision::uniform(_rnd1)));
+}
+
+template<typename RndGen, typename Precision>
+float gaussian(RndGen& _generator, float _sigma, float _mu) { return gaussian<Precision>(_generator(), _generator(), _sigma, _mu); }
+
+
+
+template<uint N, typename Precision>
+ei::Vec<float, N> gaussian(ei::Vec<uint32, N> _rnd0, ei::Vec<uint32, N> _rnd1)
+{
+    ei::Vec<float, N> res;
+    for(uint i = 0; i < N; ++i) res[i] = gaussian<Precision>(_rnd0[i], _rnd1[i]);
+    return res;
+}
+
+template<uint N, typename Precision>
+ei::Vec<float, N> gaussian(ei::Vec<uint32, N> _rnd0, ei::Vec<uint32, N> _rnd1, float _sigma, float _mu)
+{
+    ei::Vec<float, N> res;
+    for(uint i = 0; i < N; ++i) res[i] = gaussian<Precision>(_rnd0[i], _rnd1[i], _sigma, _mu);
+    return res;
+}
+
+
+
+template<typename RndGen, uint N, typename Precision>
 ei::Vec<float, N> gaussian(RndGen& _generator, const ei::Matrix<float, N, N>& _sigmaSqrt, const ei::Vec<float, N>& _mu)
 {
     // ftp://ftp.dca.fee.unicamp.br/pub/docs/vonzuben/ia013_2s09/material_de_apoio/gen_rand_multivar.pdf
@@ -85,39 +399,45 @@ ei::Vec<float, N> gaussian(RndGen& _generator, const ei::Matrix<float, N, N>& _s
     ei::Vec<float, N> res;
     // Generate two samples at a time (faster than calling gaussian() N times),
     // because the second sample of the Box-Muller transform is also used.
-    for(int i = 0; i < N; i += 2)
+    typedef typename Precision::Real Real;
+    for(uint i = 0; i + 1 < N; i += 2)
     {
-        double u0 = _generator() / 4294967295.0;
-        double u1 = _generator() / 4294967295.0;
-        double R = sqrt(ei::max(0.0, -2.0 * log(u0+1.0e-323)));
-        u1 *= 6.283185307179586476925286766559;
-        res[i]   = float(R * cos(u1));
-        res[i+1] = float(R * sin(u1));
+        Real u0 = Precision::uniformOpen(_generator());
+        Real u1 = Precision::uniform(_generator());
+        Real R = sqrt(ei::max(Real(0), Real(-2) * Precision::log(u0)));
+        Real s, c;
+        Precision::sinCos2pi(u1, s, c);
+        res[i]   = float(R * c);
+        res[i+1] = float(R * s);
     }
-    if(N & 1) res[N-1] = gaussian(_generator);
+    if(N & 1) res[N-1] = gaussian<RndGen, Precision>(_generator);
 
     // Transform by the parameters
     return _sigmaSqrt * res + _mu;
 }
 
-template<uint N>
+template<uint N, typename Precision = Precise>
 inline ei::Vec<float, N> gaussian(const ei::Vec<uint32, N>& _rnd, const ei::Matrix<float, N, N>& _sigmaSqrt, const ei::Vec<float, N>& _mu)
 {
+    // Each pair of numbers gives two samples, there is no number left for
+    // the last sample of an odd dimension.
+    static_assert((N & 1) == 0, "gaussian() from given random numbers requires an even dimension.");
     // ftp://ftp.dca.fee.unicamp.br/pub/docs/vonzuben/ia013_2s09/material_de_apoio/gen_rand_multivar.pdf
     // First generate N standard normal distributed samples.
     ei::Vec<float, N> res;
     // Generate two samples at a time (faster than calling gaussian() N times),
     // because the second sample of the Box-Muller transform is also used.
-    for(int i = 0; i < N; i += 2)
+    typedef typename Precision::Real Real;
+    for(uint i = 0; i < N; i += 2)
     {
-        double u0 = _rnd[i] / 4294967295.0;
-        double u1 = _rnd[i+1] / 4294967295.0;
-        double R = sqrt(ei::max(0.0, -2.0 * log(u0+1.0e-323)));
-        u1 *= 6.283185307179586476925286766559;
-        res[i]   = float(R * cos(u1));
-        res[i+1] = float(R * sin(u1));
+        Real u0 = Precision::uniformOpen(_rnd[i]);
+        Real u1 = Precision::uniform(_rnd[i+1]);
+        Real R = sqrt(ei::max(Real(0), Real(-2) * Precision::log(u0)));
+        Real s, c;
+        Precision::sinCos2pi(u1, s, c);
+        res[i]   = float(R * c);
+        res[i+1] = float(R * s);
     }
-    if(N & 1) res[N-1] = gaussian(_rnd[N-1]);
 
     // Transform by the parameters
     return _sigmaSqrt * res + _mu;
@@ -125,73 +445,312 @@ inline ei::Vec<float, N> gaussian(const ei::Vec<uint32, N>& _rnd, const ei::Matr
 
 
 
-inline float exponential(uint32 _rnd, float _lambda)
+template<typename Precision = Precise>
+float exponential(uint32 _rnd, float _lambda)
+{
+    return float(-Precision::log(Precision::uniformOpen(_rnd)) / _lambda);
+}
+
+template<typename RndGen, typename Precision>
+float exponential(RndGen& _generator, float _lambda) { return exponential<Precision>(_generator(), _lambda); }
+
+
+
+namespace details {
+    // Ziggurat layer tables (sampler.cpp). K: integer threshold below which a
+    // number falls into the inner rectangle of the layer, W: layer width per
+    // integer step, F: density at the upper edge of the layer.
+    extern const uint32 ZIGGURAT_GAUSS_K[128];
+    extern const float ZIGGURAT_GAUSS_W[128];
+    extern const float ZIGGURAT_GAUSS_F[128];
+    extern const uint32 ZIGGURAT_EXP_K[256];
+    extern const float ZIGGURAT_EXP_W[256];
+    extern const float ZIGGURAT_EXP_F[256];
+
+    // Uniform in ]0,1[ for the logarithms in the rare paths.
+    inline double uniformOpen(uint32 _rnd) { return (_rnd + 0.5) / 4294967296.0; }
+
+    inline uint32 absInt(int32 _x)
+    {
+        uint32 sign = uint32(_x >> 31);
+        return (uint32(_x) ^ sign) - sign;
+    }
+
+    // Samples which are not in the inner rectangle of their layer.
+    template<typename RndGen>
+    float gaussianZigguratFix(RndGen& _generator, int32 _hz, uint32 _iz)
+    {
+        const double R = 3.442619855899; // Start of the tail
+        for(;;)
+        {
+            if(_iz == 0)
+            {
+                // Tail beyond R (Marsaglia 1964)
+                double x, y;
+                do {
+                    x = -log(uniformOpen(_generator())) / R;
+                    y = -log(uniformOpen(_generator()));
+                } while(y + y < x * x);
+                return float(_hz > 0 ? R + x : -R - x);
+            }
+            // Wedge between the inner rectangle and the density
+            float x = _hz * ZIGGURAT_GAUSS_W[_iz];
+            double f0 = ZIGGURAT_GAUSS_F[_iz], f1 = ZIGGURAT_GAUSS_F[_iz - 1];
+            if(f0 + uniformOpen(_generator()) * (f1 - f0) < exp(-0.5 * x * x))
+                return x;
+            _hz = int32(_generator());
+            _iz = _hz & 127;
+            if(absInt(_hz) < ZIGGURAT_GAUSS_K[_iz])
+                return _hz * ZIGGURAT_GAUSS_W[_iz];
+        }
+    }
+
+    template<typename RndGen>
+    float exponentialZigguratFix(RndGen& _generator, uint32 _jz, uint32 _iz)
+    {
+        for(;;)
+        {
+            if(_iz == 0) // Tail (memoryless)
+                return float(7.697117470131487 - log(uniformOpen(_generator())));
+            float x = _jz * ZIGGURAT_EXP_W[_iz];
+            double f0 = ZIGGURAT_EXP_F[_iz], f1 = ZIGGURAT_EXP_F[_iz - 1];
+            if(f0 + uniformOpen(_generator()) * (f1 - f0) < exp(-x))
+                return x;
+            _jz = _generator();
+            _iz = _jz & 255;
+            if(_jz < ZIGGURAT_EXP_K[_iz])
+                return _jz * ZIGGURAT_EXP_W[_iz];
+        }
+    }
+}
+
+template<typename RndGen>
+inline float gaussianZiggurat(RndGen& _generator)
+{
+    int32 hz = int32(_generator());
+    uint32 iz = hz & 127;
+    if(details::absInt(hz) < details::ZIGGURAT_GAUSS_K[iz])
+        return hz * details::ZIGGURAT_GAUSS_W[iz];
+    return details::gaussianZigguratFix(_generator, hz, iz);
+}
+
+template<typename RndGen>
+inline float gaussianZiggurat(RndGen& _generator, float _sigma, float _mu)
+{
+    return gaussianZiggurat(_generator) * _sigma + _mu;
+}
+
+template<typename RndGen>
+inline float exponentialZiggurat(RndGen& _generator, float _lambda)
+{
+    uint32 jz = _generator();
+    uint32 iz = jz & 255;
+    if(jz < details::ZIGGURAT_EXP_K[iz])
+        return jz * details::ZIGGURAT_EXP_W[iz] / _lambda;
+    return details::exponentialZigguratFix(_generator, jz, iz) / _lambda;
+}
+
+
+
+namespace details {
+    // Draw a block of random numbers with the bulk function if available.
+    template<typename RndGen>
+    auto drawBlock(RndGen& _generator, uint32* _out, size_t _n, int) -> decltype(_generator.fill(_out, _n), void())
+    {
+        _generator.fill(_out, _n);
+    }
+
+    template<typename RndGen>
+    void drawBlock(RndGen& _generator, uint32* _out, size_t _n, long)
+    {
+        for(size_t i = 0; i < _n; ++i)
+            _out[i] = _generator();
+    }
+
+    // Number of random numbers per block of the batch samplers (even)
+    const size_t SAMPLE_BLOCK_SIZE = 256;
+
+    // Conversion kernels of the batch samplers (sampler.cpp)
+    void uniformBlock(const uint32* _rnd, float* _out, size_t _n, float _scale, float _offset);
+    void exponentialBlock(const uint32* _rnd, float* _out, size_t _n, float _lambda);
+    // _rnd contains 2*ceil(_n/2) numbers.
+    void gaussianBlock(const uint32* _rnd, float* _out, size_t _n, float _sigma, float _mu);
+
+    // Transformation of standard normal samples with a Cholesky factor for
+    // the batch multivariate gaussian() (sampler.cpp).
+    class CholeskyTransform
+    {
+    public:
+        CholeskyTransform(const float* _sigmaSqrt, const float* _mu, size_t _dim);
+
+        // Number of samples which are transformed together.
+        size_t blockSize() const { return m_blockSize; }
+        // Buffer for dim * blockSize() standard normal samples.
+        float* normals() { return m_normals.data(); }
+        // Transform _n <= blockSize() samples from normals(). The buffer is
+        // interpreted as _dim x _n matrix (each column is one sample).
+        // The results are written row-wise to _out (each row is one sample).
+        void apply(size_t _n, float* _out);
+    private:
+        size_t m_dim;
+        size_t m_dimPad;                // Dimension rounded up to a multiple of 4
+        size_t m_blockSize;
+        std::vector<float> m_factor;    // L in groups of 4 rows with interleaved columns
+        std::vector<float> m_mu;
+        std::vector<float> m_normals;
+        std::vector<float> m_result;
+    };
+}
+
+template<typename RndGen>
+void uniform(RndGen& _generator, float* _out, size_t _n)
+{
+    uniform(_generator, _out, _n, 0.0f, 1.0f);
+}
+
+template<typename RndGen>
+void uniform(RndGen& _generator, float* _out, size_t _n, float _min, float _max)
+{
+    uint32 rnd[details::SAMPLE_BLOCK_SIZE];
+    for(size_t i = 0; i < _n; i += details::SAMPLE_BLOCK_SIZE)
+    {
+        size_t m = ei::min(details::SAMPLE_BLOCK_SIZE, _n - i);
+        details::drawBlock(_generator, rnd, m, 0);
+        details::uniformBlock(rnd, _out + i, m, _max - _min, _min);
+    }
+}
+
+template<typename RndGen>
+void gaussian(RndGen& _generator, float* _out, size_t _n, float _sigma, float _mu)
+{
+    uint32 rnd[details::SAMPLE_BLOCK_SIZE];
+    for(size_t i = 0; i < _n; i += details::SAMPLE_BLOCK_SIZE)
+    {
+        size_t m = ei::min(details::SAMPLE_BLOCK_SIZE, _n - i);
+        details::drawBlock(_generator, rnd, (m + 1) & ~size_t(1), 0);
+        details::gaussianBlock(rnd, _out + i, m, _sigma, _mu);
+    }
+}
+
+template<typename RndGen>
+void exponential(RndGen& _generator, float* _out, size_t _n, float _lambda)
 {
-    double u0 = _rnd / 4294967295.0;
-    return float(-log(u0 + 1.0e-323) / _lambda);
+    uint32 rnd[details::SAMPLE_BLOCK_SIZE];
+    for(size_t i = 0; i < _n; i += details::SAMPLE_BLOCK_SIZE)
+    {
+        size_t m = ei::min(details::SAMPLE_BLOCK_SIZE, _n - i);
+        details::drawBlock(_generator, rnd, m, 0);
+        details::exponentialBlock(rnd, _out + i, m, _lambda);
+    }
 }
 
 template<typename RndGen>
-float exponential(RndGen& _generator, float _lambda) { return exponential(_generator(), _lambda); }
+void gaussian(RndGen& _generator, const float* _sigmaSqrt, const float* _mu, size_t _dim, float* _out, size_t _numSamples)
+{
+    details::CholeskyTransform transform(_sigmaSqrt, _mu, _dim);
+    for(size_t i = 0; i < _numSamples; i += transform.blockSize())
+    {
+        size_t m = ei::min(transform.blockSize(), _numSamples - i);
+        gaussian(_generator, transform.normals(), _dim * m, 1.0f, 0.0f);
+        transform.apply(m, _out + i * _dim);
+    }
+}
+
+template<typename RndGen, typename T>
+void uniformInt(RndGen& _generator, T* _out, size_t _n, T _min, T _max)
+{
+    static_assert(std::is_integral<T>::value && sizeof(T) <= 4, "The batch uniformInt() requires an integer type with at most 32 bit.");
+    uint32 range = uint32(_max) - uint32(_min) + 1;
+    uint32 threshold = range == 0 ? 0 : (0u - range) % range;
+    uint32 rnd[details::SAMPLE_BLOCK_SIZE];
+    for(size_t i = 0; i < _n; i += details::SAMPLE_BLOCK_SIZE)
+    {
+        size_t m = ei::min(details::SAMPLE_BLOCK_SIZE, _n - i);
+        details::drawBlock(_generator, rnd, m, 0);
+        if(range == 0)
+        {
+            for(size_t j = 0; j < m; ++j)
+                _out[i + j] = T(rnd[j]);
+            continue;
+        }
+        for(size_t j = 0; j < m; ++j)
+        {
+            uint64 x = uint64(rnd[j]) * range;
+            while(uint32(x) < threshold)
+                x = uint64(_generator()) * range;
+            _out[i + j] = T(uint32(_min) + uint32(x >> 32));
+        }
+    }
+}
 
 
 
-inline ei::Vec3 dirUniform(uint32 _rnd0, uint32 _rnd1)
+template<typename Precision = Precise>
+ei::Vec3 dirUniform(uint32 _rnd0, uint32 _rnd1)
 {
     float cosTheta = uniform(_rnd0) * 2.0f - 1.0f;
     float sinTheta = sqrt((1.0f - cosTheta) * (1.0f + cosTheta));
-    float phi = uniformEx(_rnd1) * 2.0f * ei::PI;
-    return ei::Vec3(sinTheta * sin(phi), sinTheta * cos(phi), cosTheta);
+    typename Precision::Real sinPhi, cosPhi;
+    Precision::sinCos2pi(uniformEx(_rnd1), sinPhi, cosPhi);
+    return ei::Vec3(sinTheta * sinPhi, sinTheta * cosPhi, cosTheta);
 }
 
-template<typename RndGen>
-ei::Vec3 dirUniform(RndGen& _generator) { return dirUniform(_generator(), _generator()); }
+template<typename RndGen, typename Precision>
+ei::Vec3 dirUniform(RndGen& _generator) { return dirUniform<Precision>(_generator(), _generator()); }
 
 
 
-inline ei::Vec3 dirCosine(uint32 _rnd0, uint32 _rnd1)
+template<typename Precision = Precise>
+ei::Vec3 dirCosine(uint32 _rnd0, uint32 _rnd1)
 {
     float x0 = uniformEx(_rnd0);
     float cosTheta = sqrt(x0);        // cos(acos(sqrt(x))) = sqrt(x)
     float sinTheta = sqrt(1.0f - x0); // sqrt(1-cos(theta)^2)
-    float phi = uniformEx(_rnd1) * 2.0f * ei::PI;
-    return ei::Vec3(sinTheta * sin(phi), sinTheta * cos(phi), cosTheta);
+    typename Precision::Real sinPhi, cosPhi;
+    Precision::sinCos2pi(uniformEx(_rnd1), sinPhi, cosPhi);
+    return ei::Vec3(sinTheta * sinPhi, sinTheta * cosPhi, cosTheta);
 }
 
-template<typename RndGen>
-ei::Vec3 dirCosine(RndGen& _generator) { return dirCosine(_generator(), _generator()); }
+template<typename RndGen, typename Precision>
+ei::Vec3 dirCosine(RndGen& _generator) { return dirCosine<Precision>(_generator(), _generator()); }
 
 
 
-inline ei::Vec3 dirCosine(uint32 _rnd0, uint32 _rnd1, float _exponent)
+template<typename Precision = Precise>
+ei::Vec3 dirCosine(uint32 _rnd0, uint32 _rnd1, float _exponent)
 {
     float x0 = uniformEx(_rnd0);
-    float cosTheta = pow(x0, 1.0f / (_exponent + 1.0f));        // cos(acos(sqrt(x))) = sqrt(x)
+    float cosTheta = Precision::pow(x0, 1.0f / (_exponent + 1.0f));        // cos(acos(sqrt(x))) = sqrt(x)
     float sinTheta = sqrt((1.0f - cosTheta) * (1.0f + cosTheta)); // sqrt(1-cos(theta)^2)
-    float phi = uniformEx(_rnd1) * 2.0f * ei::PI;
-    return ei::Vec3(sinTheta * sin(phi), sinTheta * cos(phi), cosTheta);
+    typename Precision::Real sinPhi, cosPhi;
+    Precision::sinCos2pi(uniformEx(_rnd1), sinPhi, cosPhi);
+    return ei::Vec3(sinTheta * sinPhi, sinTheta * cosPhi, cosTheta);
 }
 
-template<typename RndGen>
-ei::Vec3 dirCosine(RndGen& _generator, float _exponent) { return dirCosine(_generator(), _generator(), _exponent); }
+template<typename RndGen, typename Precision>
+ei::Vec3 dirCosine(RndGen& _generator, float _exponent) { return dirCosine<Precision>(_generator(), _generator(), _exponent); }
 
 
 
 // Isotropic GGX
-inline ei::Vec3 dirGGX(uint32 _rnd0, uint32 _rnd1, float _alpha)
+template<typename Precision = Precise>
+ei::Vec3 dirGGX(uint32 _rnd0, uint32 _rnd1, float _alpha)
 {
-    float phi = 2.0f * ei::PI * uniformEx(_rnd0);
+    typename Precision::Real sinPhi, cosPhi;
+    Precision::sinCos2pi(uniformEx(_rnd0), sinPhi, cosPhi);
     float xi = uniformEx(_rnd1);
     float e = _alpha * sqrt(xi / (1.0f - xi));
-    return normalize(ei::Vec3(-e * cos(phi), -e * sin(phi), 1.0f));
+    return normalize(ei::Vec3(-e * cosPhi, -e * sinPhi, 1.0f));
 }
 
-template<typename RndGen>
-ei::Vec3 dirGGX(RndGen& _generator, float _alpha) { return dirGGX(_generator(), _generator(), _alpha); }
+template<typename RndGen, typename Precision>
+ei::Vec3 dirGGX(RndGen& _generator, float _alpha) { return dirGGX<Precision>(_generator(), _generator(), _alpha); }
 
-inline ei::Vec3 dirGGX(uint32 _rnd0, uint32 _rnd1, float _alpha, float& _pdf)
+template<typename Precision = Precise>
+ei::Vec3 dirGGX(uint32 _rnd0, uint32 _rnd1, float _alpha, float& _pdf)
 {
-    float phi = 2.0f * ei::PI * uniformEx(_rnd0);
+    typename Precision::Real sinPhi, cosPhi;
+    Precision::sinCos2pi(uniformEx(_rnd0), sinPhi, cosPhi);
     float xi = uniformEx(_rnd1);
     float e = sqrt(xi / (1.0f - xi));
     float norm = ei::PI * _alpha * _alpha;
@@ -199,8 +758,8 @@ inline ei::Vec3 dirGGX(uint32 _rnd0, uint32 _rnd1, float _alpha, float& _pdf)
     // PDF of slopes is 1 / (norm * tmp * tmp)
 
     e *= _alpha;
-    float slopeX = e * cos(phi);
-    float slopeY = e * sin(phi);
+    float slopeX = e * cosPhi;
+    float slopeY = e * sinPhi;
     ei::Vec3 dir = normalize(ei::Vec3(-slopeX, -slopeY, 1.0f));
 
     // Transform the PDF of slopes into a PDF of normals by the Jacobian
@@ -210,31 +769,35 @@ inline ei::Vec3 dirGGX(uint32 _rnd0, uint32 _rnd1, float _alpha, float& _pdf)
     return dir;
 }
 
-template<typename RndGen>
-ei::Vec3 dirGGX(RndGen& _generator, float _alpha, float& _pdf) { return dirGGX(_generator(), _generator(), _alpha, _pdf); }
+template<typename RndGen, typename Precision>
+ei::Vec3 dirGGX(RndGen& _generator, float _alpha, float& _pdf) { return dirGGX<Precision>(_generator(), _generator(), _alpha, _pdf); }
 
 
 
 // Anisotropic GGX: http://graphicrants.blogspot.de/2013/08/specular-brdf-reference.html,
 // https://hal.inria.fr/hal-00942452v1/document "Understanding the Masking-Shadowing Function in Microfacet-Based BRDFs"
-inline ei::Vec3 dirGGX(uint32 _rnd0, uint32 _rnd1, const ei::Vec2& _alpha)
+template<typename Precision = Precise>
+ei::Vec3 dirGGX(uint32 _rnd0, uint32 _rnd1, const ei::Vec2& _alpha)
 {
-    float phi = 2.0f * ei::PI * uniformEx(_rnd0);
+    typename Precision::Real sinPhi, cosPhi;
+    Precision::sinCos2pi(uniformEx(_rnd0), sinPhi, cosPhi);
     float xi = uniformEx(_rnd1);
     ei::Vec2 e = _alpha * sqrt(xi / (1.0f - xi));
-    return normalize(ei::Vec3(-e.x * cos(phi), -e.y * sin(phi), 1.0f));
+    return normalize(ei::Vec3(-e.x * cosPhi, -e.y * sinPhi, 1.0f));
 }
 
-template<typename RndGen>
-ei::Vec3 dirGGX(RndGen& _generator, const ei::Vec2& _alpha) { return dirGGX(_generator(), _generator(), _alpha); }
+template<typename RndGen, typename Precision>
+ei::Vec3 dirGGX(RndGen& _generator, const ei::Vec2& _alpha) { return dirGGX<Precision>(_generator(), _generator(), _alpha); }
 
-inline ei::Vec3 dirGGX(uint32 _rnd0, uint32 _rnd1, const ei::Vec2& _alpha, float& _pdf)
+template<typename Precision = Precise>
+ei::Vec3 dirGGX(uint32 _rnd0, uint32 _rnd1, const ei::Vec2& _alpha, float& _pdf)
 {
-    float phi = 2.0f * ei::PI * uniformEx(_rnd0);
+    typename Precision::Real sinPhi, cosPhi;
+    Precision::sinCos2pi(uniformEx(_rnd0), sinPhi, cosPhi);
     float xi = uniformEx(_rnd1);
     float e = sqrt(xi / (1.0f - xi));
-    float slopeX = e * cos(phi); // Partially slope (missing roughness)
-    float slopeY = e * sin(phi);
+    float slopeX = e * cosPhi; // Partially slope (missing roughness)
+    float slopeY = e * sinPhi;
 
     float norm = ei::PI * _alpha.x * _alpha.y;
     float tmp = 1.0f + slopeX * slopeX + slopeY * slopeY;
@@ -251,37 +814,41 @@ inline ei::Vec3 dirGGX(uint32 _rnd0, uint32 _rnd1, const ei::Vec2& _alpha, float
     return dir;
 }
 
-template<typename RndGen>
-ei::Vec3 dirGGX(RndGen& _generator, const ei::Vec2& _alpha, float& _pdf) { return dirGGX(_generator(), _generator(), _alpha, _pdf); }
+template<typename RndGen, typename Precision>
+ei::Vec3 dirGGX(RndGen& _generator, const ei::Vec2& _alpha, float& _pdf) { return dirGGX<Precision>(_generator(), _generator(), _alpha, _pdf); }
 
 
 
-inline ei::Vec3 dirBeckmannSpizzichino(uint32 _rnd0, uint32 _rnd1, float _alpha)
+template<typename Precision = Precise>
+ei::Vec3 dirBeckmannSpizzichino(uint32 _rnd0, uint32 _rnd1, float _alpha)
 {
     // See dirBeckmannSpizzichino(RndGen&, Vec2&, float&) for details.
-    float phi = 2 * ei::PI * uniformEx(_rnd0);
+    typename Precision::Real sinPhi, cosPhi;
+    Precision::sinCos2pi(uniformEx(_rnd0), sinPhi, cosPhi);
     float xi = uniform(_rnd1) + 1e-20f;
-    float ea = _alpha * sqrt(-log(xi));
-    float slopeX = ea * cos(phi);
-    float slopeY = ea * sin(phi);
+    float ea = _alpha * sqrt(-Precision::log(xi));
+    float slopeX = ea * cosPhi;
+    float slopeY = ea * sinPhi;
     ei::Vec3 dir = normalize(ei::Vec3(-slopeX, -slopeY, 1.0f));
 
     return dir;
 }
 
-template<typename RndGen>
-ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, float _alpha) { return dirBeckmannSpizzichino(_generator(), _generator(), _alpha); }
+template<typename RndGen, typename Precision>
+ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, float _alpha) { return dirBeckmannSpizzichino<Precision>(_generator(), _generator(), _alpha); }
 
 
 
-inline ei::Vec3 dirBeckmannSpizzichino(uint32 _rnd0, uint32 _rnd1, float _alpha, float& _pdf)
+template<typename Precision = Precise>
+ei::Vec3 dirBeckmannSpizzichino(uint32 _rnd0, uint32 _rnd1, float _alpha, float& _pdf)
 {
     // See dirBeckmannSpizzichino(RndGen&, Vec2&, float&) for details.
-    float phi = 2 * ei::PI * uniformEx(_rnd0);
+    typename Precision::Real sinPhi, cosPhi;
+    Precision::sinCos2pi(uniformEx(_rnd0), sinPhi, cosPhi);
     float xi = uniform(_rnd1) + 1e-20f;
-    float ea = _alpha * sqrt(-log(xi));
-    float slopeX = ea * cos(phi);
-    float slopeY = ea * sin(phi);
+    float ea = _alpha * sqrt(-Precision::log(xi));
+    float slopeX = ea * cosPhi;
+    float slopeY = ea * sinPhi;
     ei::Vec3 dir = normalize(ei::Vec3(-slopeX, -slopeY, 1.0f));
 
     _pdf = xi / ei::max(ei::PI * _alpha * _alpha * dir.z * dir.z * dir.z, 1e-20f);
@@ -289,39 +856,43 @@ inline ei::Vec3 dirBeckmannSpizzichino(uint32 _rnd0, uint32 _rnd1, float _alpha,
     return dir;
 }
 
-template<typename RndGen>
-ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, float _alpha, float& _pdf) { return dirBeckmannSpizzichino(_generator(), _generator(), _alpha, _pdf); }
+template<typename RndGen, typename Precision>
+ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, float _alpha, float& _pdf) { return dirBeckmannSpizzichino<Precision>(_generator(), _generator(), _alpha, _pdf); }
 
 
 
-inline ei::Vec3 dirBeckmannSpizzichino(uint32 _rnd0, uint32 _rnd1, const ei::Vec2& _alpha)
+template<typename Precision = Precise>
+ei::Vec3 dirBeckmannSpizzichino(uint32 _rnd0, uint32 _rnd1, const ei::Vec2& _alpha)
 {
     // See dirBeckmannSpizzichino(RndGen&, Vec2&, float&) for details.
-    float phi = 2 * ei::PI * uniformEx(_rnd0);
+    typename Precision::Real sinPhi, cosPhi;
+    Precision::sinCos2pi(uniformEx(_rnd0), sinPhi, cosPhi);
     float xi = uniform(_rnd1) + 1e-20f;
-    float e = sqrt(-log(xi));
-    float slopeX = e * cos(phi);
-    float slopeY = e * sin(phi);
+    float e = sqrt(-Precision::log(xi));
+    float slopeX = e * cosPhi;
+    float slopeY = e * sinPhi;
     ei::Vec3 dir = normalize(ei::Vec3(-_alpha.x * slopeX, -_alpha.y * slopeY, 1.0f));
 
     return dir;
 }
 
-template<typename RndGen>
-ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, const ei::Vec2& _alpha) { return dirBeckmannSpizzichino(_generator(), _generator(), _alpha); }
+template<typename RndGen, typename Precision>
+ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, const ei::Vec2& _alpha) { return dirBeckmannSpizzichino<Precision>(_generator(), _generator(), _alpha); }
 
 
 
-inline ei::Vec3 dirBeckmannSpizzichino(uint32 _rnd0, uint32 _rnd1, const ei::Vec2& _alpha, float& _pdf)
+template<typename Precision = Precise>
+ei::Vec3 dirBeckmannSpizzichino(uint32 _rnd0, uint32 _rnd1, const ei::Vec2& _alpha, float& _pdf)
 {
     // Using slope based sampling (Heitz 2014 Importance Sampling Microfacet-Based BSDFs
     // Using the Distribution of Visible Normals, Supplemental 2).
     // The exponential in the Beck. distr. is sampled using the Box-Muller transform.
-    float phi = 2 * ei::PI * uniformEx(_rnd0);
+    typename Precision::Real sinPhi, cosPhi;
+    Precision::sinCos2pi(uniformEx(_rnd0), sinPhi, cosPhi);
     float xi = uniform(_rnd1) + 1e-20f;
-    float e = sqrt(-log(xi));
-    float slopeX = e * cos(phi);
-    float slopeY = e * sin(phi);
+    float e = sqrt(-Precision::log(xi));
+    float slopeX = e * cosPhi;
+    float slopeY = e * sinPhi;
     ei::Vec3 dir = normalize(ei::Vec3(-_alpha.x * slopeX, -_alpha.y * slopeY, 1.0f));
 
     // PDF = 1/(π α_x α_y) exp(-(sX/α_x)²-(s/α_y)²) / (n⋅h)³
@@ -334,15 +905,17 @@ inline ei::Vec3 dirBeckmannSpizzichino(uint32 _rnd0, uint32 _rnd1, const ei::Vec
     return dir;
 }
 
-template<typename RndGen>
-ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, const ei::Vec2& _alpha, float& _pdf) { return dirBeckmannSpizzichino(_generator(), _generator(), _alpha, _pdf); }
+template<typename RndGen, typename Precision>
+ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, const ei::Vec2& _alpha, float& _pdf) { return dirBeckmannSpizzichino<Precision>(_generator(), _generator(), _alpha, _pdf); }
 
 
 
-inline ei::Vec3 dirHenyeyGreenstein(uint32 _rnd0, uint32 _rnd1, float _g, const ei::Vec3& _incident)
+template<typename Precision = Precise>
+ei::Vec3 dirHenyeyGreenstein(uint32 _rnd0, uint32 _rnd1, float _g, const ShadingFrame& _incident)
 {
     // See e.g. PBRT book page 899.
-    float phi = 2.0f * ei::PI * uniformEx(_rnd0);
+    typename Precision::Real sinPhi, cosPhi;
+    Precision::sinCos2pi(uniformEx(_rnd0), sinPhi, cosPhi);
     float cosTheta;
     const float u1 = uniformEx(_rnd1);
     if(ei::abs(_g) < 1e-3f) {
@@ -352,19 +925,29 @@ inline ei::Vec3 dirHenyeyGreenstein(uint32 _rnd0, uint32 _rnd1, float _g, const
         cosTheta = (1.0f + _g * _g - sqTerm * sqTerm) / (2.0f * _g);
     }
     float sinTheta = sqrt((1.0f - cosTheta) * (1.0f + cosTheta));
-    ei::Mat3x3 localSpace = ei::basis(_incident);
-    return _incident * cosTheta + transpose((sin(phi) * sinTheta) * localSpace(1) + (cos(phi) * sinTheta) * localSpace(2));
+    return _incident.toWorld(ei::Vec3(float(sinPhi * sinTheta), float(cosPhi * sinTheta), cosTheta));
 }
 
-template<typename RndGen>
-ei::Vec3 dirHenyeyGreenstein(RndGen& _generator, float _g, const ei::Vec3& _incident) { return dirHenyeyGreenstein(_generator(), _generator(), _g, _incident); }
+template<typename Precision = Precise>
+ei::Vec3 dirHenyeyGreenstein(uint32 _rnd0, uint32 _rnd1, float _g, const ei::Vec3& _incident)
+{
+    return dirHenyeyGreenstein<Precision>(_rnd0, _rnd1, _g, ShadingFrame(_incident));
+}
+
+template<typename RndGen, typename Precision>
+ei::Vec3 dirHenyeyGreenstein(RndGen& _generator, float _g, const ei::Vec3& _incident) { return dirHenyeyGreenstein<Precision>(_generator(), _generator(), _g, _incident); }
 
+template<typename RndGen, typename Precision>
+ei::Vec3 dirHenyeyGreenstein(RndGen& _generator, float _g, const ShadingFrame& _incident) { return dirHenyeyGreenstein<Precision>(_generator(), _generator(), _g, _incident); }
 
 
-inline ei::Vec3 dirHenyeyGreenstein(uint32 _rnd0, uint32 _rnd1, float _g, const ei::Vec3& _incident, float& _pdf)
+
+template<typename Precision = Precise>
+ei::Vec3 dirHenyeyGreenstein(uint32 _rnd0, uint32 _rnd1, float _g, const ShadingFrame& _incident, float& _pdf)
 {
     // See e.g. PBRT book page 899.
-    float phi = 2.0f * ei::PI * uniformEx(_rnd0);
+    typename Precision::Real sinPhi, cosPhi;
+    Precision::sinCos2pi(uniformEx(_rnd0), sinPhi, cosPhi);
     float cosTheta;
     const float u1 = uniformEx(_rnd1);
     if(ei::abs(_g) < 1e-3f) {
@@ -381,12 +964,53 @@ inline ei::Vec3 dirHenyeyGreenstein(uint32 _rnd0, uint32 _rnd1, float _g, const
         _pdf = 1.0f / (4.0f * ei::PI) * (1.0f - _g * _g) / (sqTerm * sqTerm * sqTerm);
     }
     float sinTheta = sqrt((1.0f - cosTheta) * (1.0f + cosTheta));
-    ei::Mat3x3 localSpace = ei::basis(_incident);
-    return _incident * cosTheta + transpose((sin(phi) * sinTheta) * localSpace(1) + (cos(phi) * sinTheta) * localSpace(2));
+    return _incident.toWorld(ei::Vec3(float(sinPhi * sinTheta), float(cosPhi * sinTheta), cosTheta));
 }
 
-template<typename RndGen>
-ei::Vec3 dirHenyeyGreenstein(RndGen& _generator, float _g, const ei::Vec3& _incident, float& _pdf) { return dirHenyeyGreenstein(_generator(), _generator(), _g, _incident, _pdf); }
+template<typename Precision = Precise>
+ei::Vec3 dirHenyeyGreenstein(uint32 _rnd0, uint32 _rnd1, float _g, const ei::Vec3& _incident, float& _pdf)
+{
+    return dirHenyeyGreenstein<Precision>(_rnd0, _rnd1, _g, ShadingFrame(_incident), _pdf);
+}
+
+template<typename RndGen, typename Precision>
+ei::Vec3 dirHenyeyGreenstein(RndGen& _generator, float _g, const ei::Vec3& _incident, float& _pdf) { return dirHenyeyGreenstein<Precision>(_generator(), _generator(), _g, _incident, _pdf); }
+
+template<typename RndGen, typename Precision>
+ei::Vec3 dirHenyeyGreenstein(RndGen& _generator, float _g, const ShadingFrame& _incident, float& _pdf) { return dirHenyeyGreenstein<Precision>(_generator(), _generator(), _g, _incident, _pdf); }
+
+
+
+// Tangent space samples transformed by a frame
+template<typename RndGen, typename Precision>
+ei::Vec3 dirCosine(RndGen& _generator, const ShadingFrame& _frame) { return _frame.toWorld(dirCosine<RndGen, Precision>(_generator)); }
+
+template<typename RndGen, typename Precision>
+ei::Vec3 dirCosine(RndGen& _generator, float _exponent, const ShadingFrame& _frame) { return _frame.toWorld(dirCosine<RndGen, Precision>(_generator, _exponent)); }
+
+template<typename RndGen, typename Precision>
+ei::Vec3 dirGGX(RndGen& _generator, float _alpha, const ShadingFrame& _frame) { return _frame.toWorld(dirGGX<RndGen, Precision>(_generator, _alpha)); }
+
+template<typename RndGen, typename Precision>
+ei::Vec3 dirGGX(RndGen& _generator, float _alpha, const ShadingFrame& _frame, float& _pdf) { return _frame.toWorld(dirGGX<RndGen, Precision>(_generator, _alpha, _pdf)); }
+
+template<typename RndGen, typename Precision>
+ei::Vec3 dirGGX(RndGen& _generator, const ei::Vec2& _alpha, const ShadingFrame& _frame) { return _frame.toWorld(dirGGX<RndGen, Precision>(_generator, _alpha)); }
+
+template<typename RndGen, typename Precision>
+ei::Vec3 dirGGX(RndGen& _generator, const ei::Vec2& _alpha, const ShadingFrame& _frame, float& _pdf) { return _frame.toWorld(dirGGX<RndGen, Precision>(_generator, _alpha, _pdf)); }
+
+template<typename RndGen, typename Precision>
+ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, float _alpha, const ShadingFrame& _frame) { return _frame.toWorld(dirBeckmannSpizzichino<RndGen, Precision>(_generator, _alpha)); }
+
+template<typename RndGen, typename Precision>
+ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, float _alpha, const ShadingFrame& _frame, float& _pdf) { return _frame.toWorld(dirBeckmannSpizzichino<RndGen, Precision>(_generator, _alpha, _pdf)); }
+
+template<typename RndGen, typename Precision>
+ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, const ei::Vec2& _alpha, const ShadingFrame& _frame) { return _frame.toWorld(dirBeckmannSpizzichino<RndGen, Precision>(_generator, _alpha)); }
+
+template<typename RndGen, typename Precision>
+ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, const ei::Vec2& _alpha, const ShadingFrame& _frame, float& _pdf) { return _frame.toWorld(dirBeckmannSpizzichino<RndGen, Precision>(_generator, _alpha, _pdf)); }
 
 
 
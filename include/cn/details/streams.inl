@@ -0,0 +1,74 @@
+namespace details {
+    // Generators which are split into sub-streams with jump(). The jump
+    // distance must be large enough to allow many streams.
+    template<typename Gen> struct JumpStreams { enum { VALUE = 0 }; };
+    template<> struct JumpStreams<Lfsr113Rng> { enum { VALUE = 1 }; };
+    template<> struct JumpStreams<Well512Rng> { enum { VALUE = 1 }; };
+    template<> struct JumpStreams<Xoshiro256Rng> { enum { VALUE = 1 }; };
+
+    // Quasi-RNGs have no seed (the constructor argument is the number of
+    // dimensions). Different streams are disjoint index ranges of the same
+    // sequence instead (see at() and generateBlock()).
+    template<typename Gen> struct QuasiRandom { enum { VALUE = 0 }; };
+    template<> struct QuasiRandom<HaltonRng> { enum { VALUE = 1 }; };
+    template<> struct QuasiRandom<HaltonRevRng> { enum { VALUE = 1 }; };
+    template<> struct QuasiRandom<AdditiveRecurrenceRng> { enum { VALUE = 1 }; };
+    template<> struct QuasiRandom<HammersleyRng> { enum { VALUE = 1 }; };
+    template<> struct QuasiRandom<SobolRng> { enum { VALUE = 1 }; };
+
+    template<typename Gen, int JUMP = JumpStreams<Gen>::VALUE>
+    struct StreamCreator
+    {
+        static Gen create(const StreamFactory& _factory, ei::uint64 _streamId)
+        {
+            return Gen(_factory.seed(_streamId));
+        }
+    };
+
+    template<typename Gen>
+    struct StreamCreator<Gen, 1>
+    {
+        static Gen create(const StreamFactory& _factory, ei::uint64 _streamId)
+        {
+            // All streams share the same base sequence
+            Gen generator(_factory.seed(0));
+            generator.jump(_streamId);
+            return generator;
+        }
+    };
+
+    template<>
+    struct StreamCreator<Pcg64Rng, 0>
+    {
+        static Pcg64Rng create(const StreamFactory& _factory, ei::uint64 _streamId)
+        {
+            return Pcg64Rng(_factory.seed(0), _streamId);
+        }
+    };
+
+    // The buffer adaptor wraps the stream of the inner generator.
+    template<typename Gen, size_t BlockSize>
+    struct StreamCreator<BufferedRng<Gen, BlockSize>, 0>
+    {
+        static BufferedRng<Gen, BlockSize> create(const StreamFactory& _factory, ei::uint64 _streamId)
+        {
+            return BufferedRng<Gen, BlockSize>(StreamCreator<Gen>::create(_factory, _streamId));
+        }
+    };
+
+    ei::uint64 threadRngSeed();
+}
+
+template<typename Gen>
+Gen StreamFactory::create(ei::uint64 _streamId) const
+{
+    static_assert(!details::QuasiRandom<Gen>::VALUE, "Quasi-RNGs have no seed. Use disjoint index ranges of at() or generateBlock() as streams.");
+    return details::StreamCreator<Gen>::create(*this, _streamId);
+}
+
+template<typename Gen>
+Gen& threadRng()
+{
+    thread_local Gen generator = StreamFactory(details::threadRngSeed()).create<Gen>(threadStreamId());
+    return generator;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <type_traits>
 #include <ei/vector.hpp>
 #include "rnd.hpp"
 
@@ -11,7 +12,10 @@ namespace cn {
     // All field generators use the same syntax:
     // <name>Noise(generator, location, frequency, interpolation)
     // generator: A functor to get random values for arbitrary integer locations.
-    //      The generator must implement the 'operator () (uint32)'.
+    //      The generator must implement the 'operator () (uint32)'. The
+    //      coordinates are then hashed one after another. Alternatively,
+    //      a LatticeHash<N> of the same dimension hashes all corners of a
+    //      cell at once, which is faster (different values).
     // location: D-dimensional coordinate (sample input location)
     // frequency: Number of random samples in the [0,1] interval.
     // interpolation: Value from Interpolation enumeration to determine the
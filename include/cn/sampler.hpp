@@ -3,11 +3,30 @@
 #include <vector>
 #include <algorithm>
 #include <memory>
+#include <cstring>
+#include <cmath>
+#include <type_traits>
+#include <utility>
 #include <ei/vector.hpp>
 #include "rnd.hpp"
 
 namespace cn {
 
+    // Precision policies for the transcendental functions (sin, cos, log and
+    // pow) in the Gaussian, exponential and direction samplers. The policy
+    // is the last template argument, e.g. gaussian<Xorshift32Rng, Fast>(rng)
+    // or dirGGX<Xorshift32Rng, Fast>(rng, alpha), and is resolved at compile
+    // time. The functions on given random numbers only take the policy, e.g.
+    // gaussian<Fast>(rnd0, rnd1).
+    // Precise (default): the standard library in the precision of the
+    //      classic implementation (Box-Muller and exponential in double).
+    // Fast: single precision polynomials from the Cephes library without
+    //      branches. log has a maximum error of 1 ULP, sin and cos of 1 ULP
+    //      of 1.0 (absolute) and pow of 3e-6 relative. The samples differ
+    //      slightly from Precise for the same random numbers.
+    struct Precise;
+    struct Fast;
+
     // Get a uniform sample in [0,1] (including 1).
     template<typename RndGen>
     float uniform(RndGen& _generator);
@@ -18,22 +37,67 @@ namespace cn {
 
     // Get a uniform sample in [_min, _max] (including _max).
     // The generated number has at most 32 random bits (using a generator for 32 bit words).
+    // For integers this is slightly biased and needs a 64 bit division, see
+    // uniformInt() for an exact and faster alternative.
     template<typename RndGen, typename T>
     T uniform(RndGen& _generator, T _min, T _max);
 
+    // Get an unbiased uniform integer in [_min, _max] (including _max) with
+    // the multiply-shift method of D. Lemire "Fast Random Integer Generation
+    // in an Interval" (2019). A sample costs one multiplication (32x32->64
+    // bit for types up to 32 bit, 64x64->128 bit otherwise). Numbers in a
+    // small biased region are rejected and drawn again; only then a division
+    // is necessary. The full range of T is supported.
+    // 64 bit types consume 64 bit numbers (see uniformDouble()).
+    template<typename RndGen, typename T>
+    T uniformInt(RndGen& _generator, T _min, T _max);
+
+    // Batch version of uniformInt() for types up to 32 bit. The division for
+    // the rejection threshold is done once per call. The numbers are drawn
+    // in blocks; rejected ones are replaced by single calls to the generator.
+    template<typename RndGen, typename T>
+    void uniformInt(RndGen& _generator, T* _out, size_t _n, T _min, T _max);
+
+    // Get a uniform double in [0,1[ (excluding 1) with the full 53 bit
+    // mantissa precision. Generators with a next64() function (see rnd.hpp)
+    // are called once, all others twice (the first number gives the upper bits).
+    template<typename RndGen>
+    double uniformDouble(RndGen& _generator);
+    double uniformDouble(uint64 _rnd);
+
+    // Get a uniform double in [_min, _max[ with 53 random bits.
+    template<typename RndGen>
+    double uniformDouble(RndGen& _generator, double _min, double _max);
+
+    // Lane-wise versions of uniform() and uniformEx() for the outputs of the
+    // multi-lane generators (see rnd.hpp). Each lane is mapped exactly like
+    // the scalar function maps a single number.
+    template<uint N>
+    ei::Vec<float, N> uniform(ei::Vec<uint32, N> _rnd);
+    template<uint N>
+    ei::Vec<float, N> uniformEx(ei::Vec<uint32, N> _rnd);
+    template<uint N>
+    ei::Vec<float, N> uniform(ei::Vec<uint32, N> _rnd, float _min, float _max);
+
     // Get a Gaussian (normal distributed) sample in [-oo,oo] with standard
     // deviation 1 and mean 0.
     // This generator consumes two samples.
-    template<typename RndGen>
+    template<typename RndGen, typename Precision = Precise>
     float gaussian(RndGen& _generator);
 
     // Get a Gaussian (normal distributed) sample in [-oo,oo].
     // This generator consumes two samples.
     // _sigma: standard deviation
     // _mu: mean
-    template<typename RndGen>
+    template<typename RndGen, typename Precision = Precise>
     float gaussian(RndGen& _generator, float _sigma, float _mu);
 
+    // Lane-wise Gaussian samples from two outputs of a multi-lane generator.
+    template<uint N, typename Precision = Precise>
+    ei::Vec<float, N> gaussian(ei::Vec<uint32, N> _rnd0, ei::Vec<uint32, N> _rnd1);
+    template<uint N, typename Precision = Precise>
+    ei::Vec<float, N> gaussian(ei::Vec<uint32, N> _rnd0, ei::Vec<uint32, N> _rnd1, float _sigma, float _mu);
+
     // Get a multivariate Gaussian sample x with a distribution of
     // exp((x - mu)' S^-1 (x - mu)) where mu is the center and S the
     // covariance matrix.
@@ -42,26 +106,121 @@ namespace cn {
     //      compute L using ei::decomposeCholesky on the covariance matrix.
     //
     //      The pre-factorization allows a faster generation of multiple samples.
-    template<typename RndGen, uint N>
+    template<typename RndGen, uint N, typename Precision = Precise>
     ei::Vec<float, N> gaussian(RndGen& _generator, const ei::Matrix<float, N, N>& _sigmaSqrt, const ei::Vec<float, N>& _mu);
 
     // Get an exponential distributed sample in [0, oo].
-    template<typename RndGen>
+    template<typename RndGen, typename Precision = Precise>
     float exponential(RndGen& _generator, float _lambda);
 
+    // Gaussian and exponential samples with the Ziggurat method of Marsaglia
+    // and Tsang (2000). The density is covered by 128 (Gaussian) resp. 256
+    // (exponential) layers of equal area. In about 99% of the cases a sample
+    // costs one random number, one table lookup and one multiplication, the
+    // rest falls into the wedges or the tail and needs further numbers (and
+    // exp/log). Several times faster than gaussian() and exponential(), but
+    // the number of consumed random numbers varies.
+    template<typename RndGen>
+    float gaussianZiggurat(RndGen& _generator);
+    template<typename RndGen>
+    float gaussianZiggurat(RndGen& _generator, float _sigma, float _mu);
+    template<typename RndGen>
+    float exponentialZiggurat(RndGen& _generator, float _lambda);
+
+    // Batch versions which write _n samples to _out. The random numbers are
+    // drawn in blocks (with the bulk fill() of the generator if it has one)
+    // and converted by SIMD kernels in single precision. Therefore, the
+    // results differ slightly from the single sample functions:
+    // uniform() takes the upper 23 bits of each number as mantissa and
+    // yields samples in [0,1[ resp. [_min,_max[. The Gaussian samples are
+    // generated in pairs which consume 2*ceil(_n/2) numbers. The batch
+    // gaussian() has no default arguments, because gaussian(gen, 0, 1) would
+    // become ambiguous.
+    template<typename RndGen>
+    void uniform(RndGen& _generator, float* _out, size_t _n);
+    template<typename RndGen>
+    void uniform(RndGen& _generator, float* _out, size_t _n, float _min, float _max);
+    template<typename RndGen>
+    void gaussian(RndGen& _generator, float* _out, size_t _n, float _sigma, float _mu);
+    template<typename RndGen>
+    void exponential(RndGen& _generator, float* _out, size_t _n, float _lambda);
+
+    // Batch version of the multivariate gaussian() for a dimension _dim
+    // which is given at runtime (also large ones with hundreds of entries).
+    // Writes _numSamples samples to _out, sample i to _out[i*_dim .. (i+1)*_dim[.
+    // The standard normal samples are generated with the batch gaussian()
+    // above and transformed in blocks of samples by a SIMD matrix product.
+    // This consumes about _dim * _numSamples random numbers (more if a block
+    // has an odd number of elements).
+    // _sigmaSqrt: The lower triangular matrix L (_dim x _dim, row-major) such
+    //      that S = L * L'. The upper triangle is not read.
+    // _mu: Mean vector with _dim entries or nullptr for 0.
+    template<typename RndGen>
+    void gaussian(RndGen& _generator, const float* _sigmaSqrt, const float* _mu, size_t _dim, float* _out, size_t _numSamples);
+
+    // Orthonormal frame around a normal or an incident direction. The
+    // direction samplers below return vectors in tangent space (the normal
+    // is the z-axis). Build the frame once and transform all samples about
+    // the same normal with it instead of calling ei::basis() per sample.
+    class ShadingFrame
+    {
+    public:
+        // _normal: normalized z-axis of the tangent space. The tangent and
+        //      bitangent are the second and third row of ei::basis(_normal).
+        explicit ShadingFrame(const ei::Vec3& _normal) :
+            m_normal(_normal)
+        {
+            ei::Mat3x3 localSpace = ei::basis(_normal);
+            m_tangent = transpose(localSpace(1));
+            m_bitangent = transpose(localSpace(2));
+        }
+
+        const ei::Vec3& normal() const { return m_normal; }
+        const ei::Vec3& tangent() const { return m_tangent; }
+        const ei::Vec3& bitangent() const { return m_bitangent; }
+
+        // Transform from tangent space (x: tangent, y: bitangent, z: normal)
+        // to world space and back.
+        ei::Vec3 toWorld(const ei::Vec3& _local) const
+        {
+            return m_normal * _local.z + (m_tangent * _local.x + m_bitangent * _local.y);
+        }
+        ei::Vec3 toLocal(const ei::Vec3& _world) const
+        {
+            return ei::Vec3(dot(m_tangent, _world), dot(m_bitangent, _world), dot(m_normal, _world));
+        }
+
+        // Transform _n tangent space vectors in structure-of-arrays layout
+        // (e.g. from the batch direction samplers) to world space in place.
+        void toWorld(float* _x, float* _y, float* _z, size_t _n) const
+        {
+            for(size_t i = 0; i < _n; ++i)
+            {
+                float x = _x[i], y = _y[i], z = _z[i];
+                _x[i] = m_normal.x * z + (m_tangent.x * x + m_bitangent.x * y);
+                _y[i] = m_normal.y * z + (m_tangent.y * x + m_bitangent.y * y);
+                _z[i] = m_normal.z * z + (m_tangent.z * x + m_bitangent.z * y);
+            }
+        }
+    private:
+        ei::Vec3 m_normal;
+        ei::Vec3 m_tangent;
+        ei::Vec3 m_bitangent;
+    };
+
     // Get a uniform distributed normalized direction vector.
     // This generator consumes two samples.
-    template<typename RndGen>
+    template<typename RndGen, typename Precision = Precise>
     ei::Vec3 dirUniform(RndGen& _generator);
 
     // Get a cosine distributed normalized direction vector.
     // This generator consumes two samples.
-    template<typename RndGen>
+    template<typename RndGen, typename Precision = Precise>
     ei::Vec3 dirCosine(RndGen& _generator);
 
     // Get a cosine^n distributed normalized direction vector.
     // This generator consumes two samples.
-    template<typename RndGen>
+    template<typename RndGen, typename Precision = Precise>
     ei::Vec3 dirCosine(RndGen& _generator, float _exponent);
 
     // Get a normalized direction vector distributed after isotropic GGX NDF
@@ -69,27 +228,27 @@ namespace cn {
     // D_GGX = 1/(π α²) * 1/((x⋅h/α)² + (y⋅h/α)² + (n⋅h)²)².
     //       = 1/(π α²) * 1/((n⋅h)² + (1-(n⋅h)²)/α²)².
     // The optional returned PDF is the sample distribution D_GGX⋅(n⋅h).
-    template<typename RndGen>
+    template<typename RndGen, typename Precision = Precise>
     ei::Vec3 dirGGX(RndGen& _generator, float _alpha);
-    template<typename RndGen>
+    template<typename RndGen, typename Precision = Precise>
     ei::Vec3 dirGGX(RndGen& _generator, float _alpha, float& _pdf);
 
     // Get a normalized direction vector distributed after anisotropic GGX NDF
     // D_GGXa⋅(n⋅h) where
     // D_GGXa = 1/(π α_x α_y) * 1/((x⋅h/α_x)² + (y⋅h/α_y)² + (n⋅h)²)².
     // The optional returned PDF is the sample distribution D_GGXa⋅(n⋅h).
-    template<typename RndGen>
+    template<typename RndGen, typename Precision = Precise>
     ei::Vec3 dirGGX(RndGen& _generator, const ei::Vec2& _alpha);
-    template<typename RndGen>
+    template<typename RndGen, typename Precision = Precise>
     ei::Vec3 dirGGX(RndGen& _generator, const ei::Vec2& _alpha, float& _pdf);
 
     // Get a normalized direction vector distributed after isotropic
     // Beckmann-Spizzichino NDF D_B⋅(n⋅h) where
     // D_B = 1/(π α² (n⋅h)⁴) exp(((n⋅h)²-1) / (α² (n⋅h)²))
     // The optional returned PDF is the sample distribution D_B⋅(n⋅h).
-    template<typename RndGen>
+    template<typename RndGen, typename Precision = Precise>
     ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, float _alpha);
-    template<typename RndGen>
+    template<typename RndGen, typename Precision = Precise>
     ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, float _alpha, float& _pdf);
 
     // Get a normalized direction vector distributed after anisotropic
@@ -98,18 +257,73 @@ namespace cn {
     //     = 1/(π α_x α_y (n⋅h)⁴) exp(((n⋅h)²-1) / (n⋅h)² * ((x⋅h/α_x)² + (y⋅h/α_y)²) / (1-(n⋅h)²))
     //     = 1/(π α_x α_y (n⋅h)⁴) exp(-((x⋅h/α_x)² + (y⋅h/α_y)²) / (n⋅h)²)
     // The optional returned PDF is the sample distribution D_B⋅(n⋅h).
-    template<typename RndGen>
+    template<typename RndGen, typename Precision = Precise>
     ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, const ei::Vec2& _alpha);
-    template<typename RndGen>
+    template<typename RndGen, typename Precision = Precise>
     ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, const ei::Vec2& _alpha, float& _pdf);
 
     // Get a normalized direction vector scattered from an incident vector
     // by the Henyey-Greenstein phase function
-    template<typename RndGen>
+    template<typename RndGen, typename Precision = Precise>
     ei::Vec3 dirHenyeyGreenstein(RndGen& _generator, float _g, const ei::Vec3& _incident);
-    template<typename RndGen>
+    template<typename RndGen, typename Precision = Precise>
     ei::Vec3 dirHenyeyGreenstein(RndGen& _generator, float _g, const ei::Vec3& _incident, float& _pdf);
 
+    // The direction samplers about a fixed frame: the tangent space samples
+    // from above transformed to world space. For the Henyey-Greenstein
+    // phase function the frame is built around the incident direction.
+    template<typename RndGen, typename Precision = Precise>
+    ei::Vec3 dirCosine(RndGen& _generator, const ShadingFrame& _frame);
+    template<typename RndGen, typename Precision = Precise>
+    ei::Vec3 dirCosine(RndGen& _generator, float _exponent, const ShadingFrame& _frame);
+    template<typename RndGen, typename Precision = Precise>
+    ei::Vec3 dirGGX(RndGen& _generator, float _alpha, const ShadingFrame& _frame);
+    template<typename RndGen, typename Precision = Precise>
+    ei::Vec3 dirGGX(RndGen& _generator, float _alpha, const ShadingFrame& _frame, float& _pdf);
+    template<typename RndGen, typename Precision = Precise>
+    ei::Vec3 dirGGX(RndGen& _generator, const ei::Vec2& _alpha, const ShadingFrame& _frame);
+    template<typename RndGen, typename Precision = Precise>
+    ei::Vec3 dirGGX(RndGen& _generator, const ei::Vec2& _alpha, const ShadingFrame& _frame, float& _pdf);
+    template<typename RndGen, typename Precision = Precise>
+    ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, float _alpha, const ShadingFrame& _frame);
+    template<typename RndGen, typename Precision = Precise>
+    ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, float _alpha, const ShadingFrame& _frame, float& _pdf);
+    template<typename RndGen, typename Precision = Precise>
+    ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, const ei::Vec2& _alpha, const ShadingFrame& _frame);
+    template<typename RndGen, typename Precision = Precise>
+    ei::Vec3 dirBeckmannSpizzichino(RndGen& _generator, const ei::Vec2& _alpha, const ShadingFrame& _frame, float& _pdf);
+    template<typename RndGen, typename Precision = Precise>
+    ei::Vec3 dirHenyeyGreenstein(RndGen& _generator, float _g, const ShadingFrame& _incident);
+    template<typename RndGen, typename Precision = Precise>
+    ei::Vec3 dirHenyeyGreenstein(RndGen& _generator, float _g, const ShadingFrame& _incident, float& _pdf);
+
+    // Batch versions of the direction samplers for arrays of random numbers.
+    // Direction i is computed from _rnd0[i] and _rnd1[i] like in the single
+    // sample functions dirUniform(_rnd0[i], _rnd1[i]) etc. The components
+    // are written to the structure-of-arrays outputs _x, _y and _z. _pdf is
+    // optional and receives the same PDF as the single sample functions.
+    // Sine, cosine and logarithm are polynomial approximations. Compared to
+    // the single sample functions (with libm) the components differ by at
+    // most 4 ULP of 1.0 (5e-7 absolute) and the PDF by at most 1e-5
+    // relative. An anisotropic _alpha scales the component bound by up to
+    // max(_alpha) / min(_alpha), because the single sample functions round
+    // the angle in radians. The results do not depend on the instruction set.
+    void dirUniform(const uint32* _rnd0, const uint32* _rnd1, size_t _n, float* _x, float* _y, float* _z);
+    void dirCosine(const uint32* _rnd0, const uint32* _rnd1, size_t _n, float* _x, float* _y, float* _z);
+    void dirGGX(const uint32* _rnd0, const uint32* _rnd1, size_t _n, float _alpha,
+        float* _x, float* _y, float* _z, float* _pdf = nullptr);
+    void dirGGX(const uint32* _rnd0, const uint32* _rnd1, size_t _n, const ei::Vec2& _alpha,
+        float* _x, float* _y, float* _z, float* _pdf = nullptr);
+    void dirBeckmannSpizzichino(const uint32* _rnd0, const uint32* _rnd1, size_t _n, float _alpha,
+        float* _x, float* _y, float* _z, float* _pdf = nullptr);
+    void dirBeckmannSpizzichino(const uint32* _rnd0, const uint32* _rnd1, size_t _n, const ei::Vec2& _alpha,
+        float* _x, float* _y, float* _z, float* _pdf = nullptr);
+    // Batch Henyey-Greenstein samples around a fixed incident direction. In
+    // contrast to the other batch samplers the directions are in world space.
+    // Use ShadingFrame::toWorld() to transform the outputs of the others.
+    void dirHenyeyGreenstein(const uint32* _rnd0, const uint32* _rnd1, size_t _n, float _g, const ShadingFrame& _incident,
+        float* _x, float* _y, float* _z, float* _pdf = nullptr);
+
     // Get a uniform distributed sample on a unit disc area
     // This generator consumes two samples.
     template<typename RndGen>
@@ -123,32 +337,110 @@ namespace cn {
     // include inline implementation
 #   include "details/sampler.inl"
 
+namespace details {
+    // Replace _values by their prefix sums. The sums are accumulated in double
+    // precision and rounded once to float. Large arrays are processed in
+    // blocks by up to _numThreads threads (0 for all hardware threads). The
+    // result does not depend on the number of threads.
+    // Returns the total sum.
+    double prefixSum(float* _values, size_t _n, uint32 _numThreads = 1);
+
+    // Hint to load the cache line of _p (ignored by other compilers).
+    inline void prefetch(const void* _p)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(_p);
+#else
+        (void)_p;
+#endif
+    }
+
+    // Inverse of a prefix sum array (CDF) with a guide table (cutpoint
+    // method, see L. Devroye "Non-Uniform Random Variate Generation" 1986,
+    // chapter III.2.4). The buckets divide [0, integral] into size equal
+    // parts and guide[g] is the first index whose CDF value falls into the
+    // bucket g or above. A search starts there and scans forward, which
+    // takes a constant number of steps in expectation instead of a binary
+    // search. Used by DiscreteFunction1D and the rows of DiscreteFunction2D.
+    struct GuidedCdf
+    {
+        const float* cdf;
+        const uint32* guide;    // size + 2 entries, see buildGuide()
+        uint32 size;
+        float guideScale;       // Number of buckets divided by the integral
+
+        uint32 bucket(float _x) const { return uint32(_x * guideScale); }
+        // Sum over all values of the function
+        float total() const { return cdf[size-1]; }
+
+        // Fill _guide with _size + 2 entries (rounding can map the integral
+        // to bucket _size, one more for safety) and return the scale.
+        // Large tables are processed by up to _numThreads threads (0 for all
+        // hardware threads, see prefixSum()).
+        static float buildGuide(const float* _cdf, uint32 _size, uint32* _guide, uint32 _numThreads = 1);
+
+        // Same as std::lower_bound: first index with cdf[i] >= _x. All
+        // entries before the guide are in smaller buckets and therefore
+        // below _x, and the scan ends at the last entry at the latest.
+        int find(float _x) const
+        {
+            uint32 g = bucket(_x);
+            // The result is usually close to its bucket: load the CDF there
+            // in parallel to the guide (both miss the cache in large tables).
+            prefetch(cdf + ei::min(g, size - 1));
+            uint32 i = guide[g];
+            while(cdf[i] < _x) ++i;
+            return int(i);
+        }
+
+        // Continuous sample in [0,1] for _x in [0, integral].
+        float sampleAt(float _x, float * _pdf, int * _off) const
+        {
+            int o = find(_x);
+            if(_off)
+                *_off = o;
+            float v0 = o == 0 ? 0.0f : cdf[o-1];
+            float v1 = cdf[o];
+            if(_pdf)
+                *_pdf = (v1 - v0) * size / total();
+            _x = (_x - v0) / (v1 - v0); // Inverse of linear interpolation
+            return (o + _x) / size;
+        }
+    };
+}
+
     class DiscreteFunction1D
     {
     public:
         // _func: A function specified by discrete samples. The ownership of the memory is
         //    taken and its content will be converted to a prefixsum array.
-        //    A function should not have more than a few thousand entries. Otherwise numeric
-        //    will cause the loss of small samples.
-        DiscreteFunction1D(std::vector<float> _func) :
-            m_cdf(std::move(_func))
-        {
-            float sum = 0.0f;
-            //int n = int(_func.size()); // Normalize by sample number to map to [0,1]
-            for(auto & it : m_cdf)
-            {
-                sum += it;
-                it = sum;
-            }
+        //    The sums are computed in double precision, but stored as float.
+        //    Entries below ~1e-7 of the total sum can therefore not be
+        //    distinguished from 0.
+        // _numThreads: Maximum number of threads which build large tables. The
+        //    default builds on the calling thread only, 0 uses all hardware
+        //    threads. The table does not depend on this number.
+        DiscreteFunction1D(std::vector<float> _func, uint32 _numThreads = 1) :
+            m_cdf(std::move(_func)),
+            m_guide(m_cdf.size() + 2)
+        {
+            details::prefixSum(m_cdf.data(), m_cdf.size(), _numThreads);
+            m_guideScale = details::GuidedCdf::buildGuide(m_cdf.data(), uint32(m_cdf.size()), m_guide.data(), _numThreads);
         }
 
         // Get a random index of the original function (consumes one random number).
         template<typename RndGen>
         int sampleDiscrete(RndGen & _generator) const
         {
-            float x = uniform(_generator, 0.0f, m_cdf.back());
-            auto it = std::lower_bound(m_cdf.begin(), m_cdf.end(), x);
-            return int(it - m_cdf.begin());
+            return cdf().find(uniform(_generator, 0.0f, m_cdf.back()));
+        }
+
+        // Version for a given random number, e.g. from a low discrepancy
+        // sequence (HaltonRng, HammersleyRng). The mapping from _rnd to the
+        // index is monotone, so stratified numbers give stratified samples.
+        int sampleDiscrete(uint32 _rnd) const
+        {
+            return cdf().find(uniform(_rnd, 0.0f, m_cdf.back()));
         }
 
         // Sample a value in [0,1] continuously (consumes one random number).
@@ -157,24 +449,216 @@ namespace cn {
         template<typename RndGen>
         float sample(RndGen & _generator, float * _pdf = nullptr, int * _off = nullptr) const
         {
-            float x = uniform(_generator, 0.0f, m_cdf.back());
-            auto it = std::lower_bound(m_cdf.begin(), m_cdf.end(), x);
-            int o = int(it - m_cdf.begin());
+            return cdf().sampleAt(uniform(_generator, 0.0f, m_cdf.back()), _pdf, _off);
+        }
+
+        // Monotone inverse of the CDF for a given random number.
+        float sample(uint32 _rnd, float * _pdf = nullptr, int * _off = nullptr) const
+        {
+            return cdf().sampleAt(uniform(_rnd, 0.0f, m_cdf.back()), _pdf, _off);
+        }
+
+        // Integral value over the interval [0,1].
+        float integral() const { return m_cdf.back() / m_cdf.size(); }
+
+    private:
+        std::vector<float> m_cdf; // Integral over the function without any normalization.
+        std::vector<uint32> m_guide;
+        float m_guideScale;
+
+        details::GuidedCdf cdf() const { return details::GuidedCdf{m_cdf.data(), m_guide.data(), uint32(m_cdf.size()), m_guideScale}; }
+    };
+
+    // Alternative to DiscreteFunction1D with constant time sampling by the
+    // alias method (Walker 1977, construction after M. D. Vose "A linear
+    // algorithm for generating random numbers with a given distribution"
+    // 1991). Each entry of the table is chosen with probability 1/n and
+    // then either kept or replaced by its alias. A sample reads a single
+    // entry of the table (16 bytes) and needs no search, therefore this is
+    // much faster for large functions. The construction is in double
+    // precision, so small values are not lost in large functions.
+    // The results differ from DiscreteFunction1D for the same random numbers.
+    class AliasTable1D
+    {
+    public:
+        // _func: A function specified by discrete non-negative samples with at
+        //    least one positive value.
+        explicit AliasTable1D(const std::vector<float>& _func);
+
+        // Get a random index of the original function (consumes one random number).
+        // The upper bits of the number choose the entry and the lower bits
+        // decide between the entry and its alias. The probabilities are
+        // represented with a resolution of about n / 2^32.
+        int sampleDiscrete(uint32 _rnd) const
+        {
+            uint64 x = uint64(_rnd) * m_table.size();
+            const Entry& e = m_table[size_t(x >> 32)];
+            return uint32(x) < e.threshold ? int(x >> 32) : e.alias;
+        }
+
+        template<typename RndGen>
+        int sampleDiscrete(RndGen & _generator) const
+        {
+            return sampleDiscrete(uint32(_generator()));
+        }
+
+        // Sample a value in [0,1] continuously (consumes one random number).
+        // The remaining bits of the decision between entry and alias give the
+        // position inside the chosen interval.
+        // _pdf: Optional return value for the probability density value at the sampled
+        //     position.
+        float sample(uint32 _rnd, float * _pdf = nullptr, int * _off = nullptr) const
+        {
+            uint64 x = uint64(_rnd) * m_table.size();
+            const Entry& e = m_table[size_t(x >> 32)];
+            uint32 frac = uint32(x);
+            int o = int(x >> 32);
+            // The interval fractions are computed in double: float(threshold)
+            // rounds up to 2^32 for thresholds close to it. Full entries
+            // (their own alias) are always kept.
+            double u;
+            if(frac < e.threshold || e.alias == o)
+            {
+                u = frac / double(e.threshold);
+                if(_pdf) *_pdf = e.pdf;
+            } else {
+                o = e.alias;
+                u = (frac - e.threshold) / (4294967296.0 - e.threshold);
+                if(_pdf) *_pdf = e.aliasPdf;
+            }
+            if(_off)
+                *_off = o;
+            return float((o + u) / m_table.size());
+        }
+
+        template<typename RndGen>
+        float sample(RndGen & _generator, float * _pdf = nullptr, int * _off = nullptr) const
+        {
+            return sample(uint32(_generator()), _pdf, _off);
+        }
+
+        // Integral value over the interval [0,1].
+        float integral() const { return m_integral; }
+
+    private:
+        struct Entry
+        {
+            uint32 threshold;   // Keep the entry if the lower 32 bits are below
+            int alias;
+            float pdf;          // Density of the entry and of its alias
+            float aliasPdf;
+        };
+        std::vector<Entry> m_table;
+        float m_integral;
+    };
+
+    // Discrete function with weights that can be changed after construction
+    // (e.g. for adaptive sampling or light selection). The weights are the
+    // leaves of a sum tree with 8 children per node. A node stores the prefix
+    // sums of its children in double precision, which is one cache line, so
+    // a sample reads log8(n) cache lines and an update recomputes log8(n)
+    // nodes. The nodes are recomputed from the children instead of adding
+    // differences, therefore repeated updates do not drift. In contrast to
+    // DiscreteFunction1D, entries with a weight of 0 are never sampled.
+    class DynamicDiscreteFunction1D
+    {
+    public:
+        // _func: Initial non-negative weights (the size is fixed afterwards).
+        //    At least one weight must be positive when sampling. An empty
+        //    function has an integral of 0 and cannot be sampled.
+        explicit DynamicDiscreteFunction1D(std::vector<float> _func);
+
+        // A copy gets a new buffer, so its nodes are aligned again. Moves
+        // keep the buffer and its alignment.
+        DynamicDiscreteFunction1D(const DynamicDiscreteFunction1D& _other);
+        DynamicDiscreteFunction1D(DynamicDiscreteFunction1D&&) = default;
+        DynamicDiscreteFunction1D& operator = (const DynamicDiscreteFunction1D& _other);
+        DynamicDiscreteFunction1D& operator = (DynamicDiscreteFunction1D&&) = default;
+
+        // Set the weight of a single entry in O(log n).
+        void update(int _index, float _weight);
+
+        // Set the weights of _n entries. Many updates are applied to the
+        // weights directly and the tree is rebuilt in O(size()).
+        void update(const int* _indices, const float* _weights, size_t _n);
+
+        float weight(int _index) const { return m_weights[_index]; }
+        size_t size() const { return m_weights.size(); }
+
+        // Get a random index of the function (consumes one random number).
+        int sampleDiscrete(uint32 _rnd) const
+        {
+            double x = _rnd * (total() / 4294967296.0);
+            return find(x);
+        }
+
+        template<typename RndGen>
+        int sampleDiscrete(RndGen & _generator) const
+        {
+            return sampleDiscrete(uint32(_generator()));
+        }
+
+        // Sample a value in [0,1] continuously (consumes one random number).
+        // _pdf: Optional return value for the probability density value at the sampled
+        //     position.
+        float sample(uint32 _rnd, float * _pdf = nullptr, int * _off = nullptr) const
+        {
+            double x = _rnd * (total() / 4294967296.0);
+            int o = find(x);
             if(_off)
                 *_off = o;
-            float v0 = o == 0 ? 0.0f : *(it-1);
-            float v1 = *it;
             if(_pdf)
-                *_pdf = (v1 - v0) * m_cdf.size() / m_cdf.back();
-            x = (x - v0) / (v1 - v0); // Inverse of linear interpolation
-            return (o + x) / m_cdf.size();
+                *_pdf = float(m_weights[o] * m_weights.size() / total());
+            // x is the remainder inside the entry o
+            float u = float(x / m_weights[o]);
+            return (o + u) / m_weights.size();
+        }
+
+        template<typename RndGen>
+        float sample(RndGen & _generator, float * _pdf = nullptr, int * _off = nullptr) const
+        {
+            return sample(uint32(_generator()), _pdf, _off);
         }
 
         // Integral value over the interval [0,1].
-        float integral() const { return m_cdf.back() / m_cdf.size(); }
+        float integral() const { return m_weights.empty() ? 0.0f : float(total() / m_weights.size()); }
 
     private:
-        std::vector<float> m_cdf; // Integral over the function without any normalization.
+        std::vector<float> m_weights;
+        // Nodes of all levels, the leaf level first. The 8 values of a node
+        // are the inclusive prefix sums of its children, missing children
+        // of the last node of a level count as 0.
+        std::vector<double> m_nodes;
+        // Start of each level in m_nodes and the end of the top level (which
+        // has a single node). The starts are shifted to align the nodes to
+        // 64 bytes.
+        std::vector<size_t> m_levels;
+
+        // Allocate the aligned levels and compute all nodes from m_weights.
+        void build();
+        double total() const { return m_nodes[m_levels[m_levels.size() - 2] + 7]; }
+        size_t numNodes(size_t _level) const { return (m_levels[_level + 1] - m_levels[_level]) / 8; }
+        void updateNode(size_t _level, size_t _node);
+
+        // Descent from the root: in each node the first child whose prefix
+        // sum is larger than _x. _x is limited to the total of the node
+        // first, so a child with a positive sum is found even if rounding
+        // pushed _x beyond. _x is reduced to the remainder in the returned entry.
+        int find(double& _x) const
+        {
+            size_t node = 0;
+            for(size_t l = m_levels.size() - 1; l-- > 0;)
+            {
+                const double* p = m_nodes.data() + m_levels[l] + node * 8;
+                _x = _x < p[7] ? _x : p[7] * (1.0 - 2.2204460492503131e-16);
+                size_t c = 0;
+                for(int k = 0; k < 7; ++k)
+                    c += p[k] <= _x;
+                _x -= c ? p[c - 1] : 0.0;
+                node = node * 8 + c;
+            }
+            return int(node);
+        }
     };
 
     class DiscreteFunction2D
@@ -182,28 +666,29 @@ namespace cn {
     public:
         // _func: A 2D function of discrete values. The inner vectors are called
         //     rows and may have different lengths.
-        //    A row should not have more than a few thousand entries. Otherwise numeric
-        //    will cause the loss of small samples. Also, there shouldn't be to many rows.
-        DiscreteFunction2D(std::vector<std::vector<float>> _func) :
-            m_colPDF(nullptr)
-        {
-            std::vector<float> m_rowIntegrals;
-            m_rowPDFs.reserve(_func.size());
-            m_rowIntegrals.reserve(_func.size());
-            for(auto & row : _func)
-            {
-                m_rowPDFs.push_back(std::move(row));
-                m_rowIntegrals.push_back(m_rowPDFs.back().integral());
-            }
-            m_colPDF = std::make_unique<DiscreteFunction1D>(std::move(m_rowIntegrals));
+        //    The rows are built with the same precision as DiscreteFunction1D.
+        // _numThreads: Maximum number of threads which build the rows, see
+        //    DiscreteFunction1D.
+        DiscreteFunction2D(const std::vector<std::vector<float>>& _func, uint32 _numThreads = 1) :
+            DiscreteFunction2D(build(_func.size(), [&_func](size_t _y) { return std::make_pair(_func[_y].data(), _func[_y].size()); }, _numThreads))
+        {
+        }
+
+        // A 2D function in row-major order, e.g. an image, which is only read
+        // during the construction (no intermediate copies).
+        // _stride: Distance between the starts of two rows in elements (0 for _width).
+        DiscreteFunction2D(const float* _func, int _width, int _height, size_t _stride = 0, uint32 _numThreads = 1) :
+            DiscreteFunction2D(build(size_t(_height), [=](size_t _y) { return std::make_pair(_func + _y * (_stride ? _stride : _width), size_t(_width)); }, _numThreads))
+        {
         }
 
         // Get a random index of the original function (consumes two random numbers).
         template<typename RndGen>
         ei::IVec2 sampleDiscrete(RndGen & _generator) const
         {
-            int y = m_colPDF->sampleDiscrete(_generator);
-            return ei::IVec2(m_rowPDFs[y].sampleDiscrete(_generator), y);
+            int y = m_colPDF.sampleDiscrete(_generator);
+            details::GuidedCdf r = row(y);
+            return ei::IVec2(r.find(uniform(_generator, 0.0f, r.total())), y);
         }
 
         // Sample a value in [0,1]^2 continuously (consumes two random numbers).
@@ -217,23 +702,112 @@ namespace cn {
             if(_pdf)
             {
                 float pdfX, pdfY;
-                float y = m_colPDF->sample(_generator, &pdfY, &_off->y);
-                float x = m_rowPDFs[_off->y].sample(_generator, &pdfX, &_off->x);
+                float y = m_colPDF.sample(_generator, &pdfY, &_off->y);
+                details::GuidedCdf r = row(_off->y);
+                float x = r.sampleAt(uniform(_generator, 0.0f, r.total()), &pdfX, &_off->x);
                 *_pdf = pdfX * pdfY;
                 return ei::Vec2(x,y);
             } else {
-                float y = m_colPDF->sample(_generator, nullptr, &_off->y);
-                float x = m_rowPDFs[_off->y].sample(_generator, nullptr, &_off->x);
+                float y = m_colPDF.sample(_generator, nullptr, &_off->y);
+                details::GuidedCdf r = row(_off->y);
+                float x = r.sampleAt(uniform(_generator, 0.0f, r.total()), nullptr, &_off->x);
                 return ei::Vec2(x,y);
             }
         }
 
+        // Versions for given random numbers (_rnd0 chooses the row, _rnd1 the
+        // position in the row). Both mappings are monotone inverse CDFs.
+        ei::IVec2 sampleDiscrete(uint32 _rnd0, uint32 _rnd1) const
+        {
+            int y = m_colPDF.sampleDiscrete(_rnd0);
+            details::GuidedCdf r = row(y);
+            return ei::IVec2(r.find(uniform(_rnd1, 0.0f, r.total())), y);
+        }
+
+        ei::Vec2 sample(uint32 _rnd0, uint32 _rnd1, float * _pdf = nullptr, ei::IVec2 * _off = nullptr) const
+        {
+            ei::IVec2 off;
+            if(!_off) _off = & off;
+            float pdfX, pdfY;
+            float y = m_colPDF.sample(_rnd0, &pdfY, &_off->y);
+            details::GuidedCdf r = row(_off->y);
+            float x = r.sampleAt(uniform(_rnd1, 0.0f, r.total()), &pdfX, &_off->x);
+            if(_pdf)
+                *_pdf = pdfX * pdfY;
+            return ei::Vec2(x,y);
+        }
+
         // Integral value over the interval area [0,1]^2.
-        float integral() const { return m_colPDF->integral(); }
+        float integral() const { return m_colPDF.integral(); }
 
     private:
-        std::vector<DiscreteFunction1D> m_rowPDFs;
-        std::unique_ptr<DiscreteFunction1D> m_colPDF;
+        // All rows are stored in the same buffers, a sample reads one entry
+        // of the row table and the two ranges of the row.
+        struct Row
+        {
+            uint32 offset;      // First entry in m_cdf
+            uint32 size;
+            uint32 guideOffset; // First entry in m_guide (size + 2 entries)
+            float guideScale;
+        };
+        std::vector<float> m_cdf;       // Prefix sums of all rows
+        std::vector<uint32> m_guide;    // Guide tables of all rows
+        std::vector<Row> m_rows;
+        DiscreteFunction1D m_colPDF;    // Marginal distribution of the rows
+
+        details::GuidedCdf row(int _y) const
+        {
+            const Row& r = m_rows[_y];
+            return details::GuidedCdf{m_cdf.data() + r.offset, m_guide.data() + r.guideOffset, r.size, r.guideScale};
+        }
+
+        // All buffers of a function. They are built before any member is
+        // initialized and then moved into the members.
+        struct Tables
+        {
+            std::vector<float> cdf;
+            std::vector<uint32> guide;
+            std::vector<Row> rows;
+            std::vector<float> rowIntegrals;    // Input for the marginal distribution
+            uint32 numThreads;
+        };
+
+        DiscreteFunction2D(Tables&& _tables) :
+            m_cdf(std::move(_tables.cdf)),
+            m_guide(std::move(_tables.guide)),
+            m_rows(std::move(_tables.rows)),
+            m_colPDF(std::move(_tables.rowIntegrals), _tables.numThreads)
+        {
+        }
+
+        // Build all rows. _row(y) returns the pointer to and the length of row y.
+        template<typename RowFunc>
+        static Tables build(size_t _numRows, RowFunc _row, uint32 _numThreads)
+        {
+            Tables tables;
+            tables.numThreads = _numThreads;
+            tables.rows.resize(_numRows);
+            std::vector<const float*> values(_numRows);
+            uint32 offset = 0;
+            for(size_t y = 0; y < _numRows; ++y)
+            {
+                auto v = _row(y);
+                values[y] = v.first;
+                tables.rows[y].offset = offset;
+                tables.rows[y].size = uint32(v.second);
+                tables.rows[y].guideOffset = offset + 2 * uint32(y);
+                offset += uint32(v.second);
+            }
+            tables.cdf.resize(offset);
+            tables.guide.resize(offset + 2 * _numRows);
+            tables.rowIntegrals.resize(_numRows);
+            buildRows(values.data(), tables);
+            return tables;
+        }
+
+        // Compute the CDFs, guide tables and integrals of all rows with up to
+        // _tables.numThreads threads (sampler.cpp).
+        static void buildRows(const float* const* _values, Tables& _tables);
     };
 
 } // namespace cn
\ No newline at end of file
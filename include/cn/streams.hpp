@@ -0,0 +1,61 @@
+#pragma once
+
+#include "rnd.hpp"
+
+namespace cn {
+
+    // Deterministic independent streams from one master seed.
+    // Instead of seeding each generator with generateSeed() (slow, not
+    // reproducible and possibly colliding for threads started at the same
+    // time) a StreamFactory hands out one generator per thread or task id.
+    // The same master seed and id always give the same generator.
+    //
+    // Generators with a long jump() (Lfsr113Rng, Well512Rng, Xoshiro256Rng)
+    // are seeded once with the master seed and advanced by id jumps, which
+    // guarantees non-overlapping sub-streams. The jumps are combined in
+    // O(log id). Pcg64Rng uses the id as stream selector. BufferedRng wraps
+    // the stream of its generator. All other generators receive a hashed seed
+    // of (master, id). Quasi-RNGs cannot be created (compile error), because
+    // they have no seed.
+    //
+    // Example:
+    //      StreamFactory streams(1234);
+    //      // In worker thread i:
+    //      Xoshiro256Rng rng = streams.create<Xoshiro256Rng>(i);
+    class StreamFactory
+    {
+        ei::uint64 masterSeed;
+    public:
+        explicit StreamFactory(ei::uint64 _masterSeed);
+
+        // Derived seed for the stream with the given id (hashed key derivation).
+        ei::uint64 seed(ei::uint64 _streamId) const;
+
+        // A generator of type Gen for the stream with the given id.
+        template<typename Gen>
+        Gen create(ei::uint64 _streamId) const;
+    };
+
+    // Set the master seed for all generators returned by threadRng().
+    // Must be called before the first use of threadRng() (default 0).
+    void setThreadRngSeed(ei::uint64 _masterSeed);
+
+    // Set the stream id of the calling thread for threadRng(). Must be called
+    // before the first use of threadRng() in this thread. Without an explicit
+    // id, threads receive the ids 0, 1, 2, ... in the order of their first
+    // use which is only reproducible if threads start in a fixed order.
+    void setThreadStreamId(ei::uint64 _streamId);
+
+    // Stream id of the calling thread (assigned on first query).
+    ei::uint64 threadStreamId();
+
+    // Generator of the calling thread. It is created once per thread and
+    // type from StreamFactory(master seed).create<Gen>(threadStreamId()),
+    // afterwards the access is a plain thread_local lookup.
+    template<typename Gen>
+    Gen& threadRng();
+
+    // include inline implementation
+#   include "details/streams.inl"
+
+} // namespace cn
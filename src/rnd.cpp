@@ -1,20 +1,210 @@
 #include "cn/rnd.hpp"
 #include <ctime>
 #include <thread>
+#include <algorithm>
+#include <vector>
+#include "simd.hpp"
 
 namespace cn {
 
+    // Combine pairs of 32 bit numbers into 64 bit numbers (first number in the upper half).
+    template<typename RndGen>
+    static void fill64(RndGen& _generator, ei::uint64* _out, size_t _n)
+    {
+        ei::uint32 buffer[128];
+        while(_n > 0)
+        {
+            size_t m = std::min<size_t>(_n, 64);
+            _generator.fill(buffer, m * 2);
+            for(size_t i = 0; i < m; ++i)
+                _out[i] = (ei::uint64(buffer[2*i]) << 32) | buffer[2*i+1];
+            _out += m;
+            _n -= m;
+        }
+    }
+
+    // Linear map on GF(2)^32 given by the images of the basis vectors.
+    struct Gf2Matrix32
+    {
+        ei::uint32 col[32];
+
+        ei::uint32 apply(ei::uint32 _x) const
+        {
+            ei::uint32 r = 0;
+            for(int j = 0; _x; ++j, _x >>= 1)
+                if(_x & 1) r ^= col[j];
+            return r;
+        }
+
+        Gf2Matrix32 operator * (const Gf2Matrix32& _rhs) const
+        {
+            Gf2Matrix32 res;
+            for(int j = 0; j < 32; ++j)
+                res.col[j] = apply(_rhs.col[j]);
+            return res;
+        }
+    };
+
+    // Compute _m^_n * _x by squaring.
+    static ei::uint32 gf2Power(Gf2Matrix32 _m, ei::uint64 _n, ei::uint32 _x)
+    {
+        while(_n)
+        {
+            if(_n & 1) _x = _m.apply(_x);
+            _n >>= 1;
+            if(_n) _m = _m * _m;
+        }
+        return _x;
+    }
+
+    // Polynomials over GF(2) with degree <= 512 for the jump-ahead of Well512
+    // and xoshiro256.
+    // Bit i of word i/64 is the coefficient of x^i.
+    struct Gf2Poly512
+    {
+        enum { WORDS = 9 };
+        ei::uint64 w[WORDS];
+
+        Gf2Poly512() { for(int i = 0; i < WORDS; ++i) w[i] = 0; }
+        bool coeff(int _i) const { return (w[_i / 64] >> (_i % 64)) & 1; }
+        void flip(int _i) { w[_i / 64] ^= 1ull << (_i % 64); }
+    };
+
+    // Compute _a * _b mod _p, where deg(_a), deg(_b) < _degree = deg(_p) <= 512.
+    static Gf2Poly512 gf2MulMod(const Gf2Poly512& _a, const Gf2Poly512& _b, const Gf2Poly512& _p, int _degree = 512)
+    {
+        // Carry-less product (degree < 2 * _degree - 1)
+        ei::uint64 r[16] = {0};
+        for(int i = 0; i < _degree; ++i)
+        {
+            if(!_a.coeff(i)) continue;
+            int ws = i / 64, bs = i % 64;
+            for(int k = 0; k < 8; ++k)
+            {
+                r[k + ws] ^= _b.w[k] << bs;
+                if(bs) r[k + ws + 1] ^= _b.w[k] >> (64 - bs);
+            }
+        }
+        // Reduce from the top
+        for(int i = 2 * _degree - 2; i >= _degree; --i)
+        {
+            if(!((r[i / 64] >> (i % 64)) & 1)) continue;
+            int ws = (i - _degree) / 64, bs = (i - _degree) % 64;
+            for(int k = 0; k < Gf2Poly512::WORDS && k + ws < 16; ++k)
+            {
+                r[k + ws] ^= _p.w[k] << bs;
+                if(bs && k + ws + 1 < 16) r[k + ws + 1] ^= _p.w[k] >> (64 - bs);
+            }
+        }
+        Gf2Poly512 res;
+        for(int k = 0; k < 8; ++k) res.w[k] = r[k];
+        return res;
+    }
+
+    // Compute _x^_n mod _p by squaring.
+    static Gf2Poly512 gf2PowMod(Gf2Poly512 _x, ei::uint64 _n, const Gf2Poly512& _p, int _degree = 512)
+    {
+        Gf2Poly512 res;
+        res.flip(0);
+        while(_n)
+        {
+            if(_n & 1) res = gf2MulMod(res, _x, _p, _degree);
+            _n >>= 1;
+            if(_n) _x = gf2MulMod(_x, _x, _p, _degree);
+        }
+        return res;
+    }
+
+    // Characteristic polynomial of an F2-linear generator with maximal period
+    // 2^_degree-1. The polynomial is primitive and equals the minimal
+    // polynomial of any bit sequence of the state. It is found with the
+    // Berlekamp-Massey algorithm from 2*_degree bits of such a sequence.
+    static Gf2Poly512 gf2CharPoly(const bool* _seq, int _degree)
+    {
+        const int N = 1024;
+        const int n = 2 * _degree;
+        // Connection polynomials (degree <= 512, stored with bool arrays for simplicity)
+        bool c[N+1] = {false}, b[N+1] = {false}, t[N+1];
+        c[0] = b[0] = true;
+        int l = 0, m = 1;
+        for(int k = 0; k < n; ++k)
+        {
+            bool d = _seq[k];
+            for(int i = 1; i <= l; ++i) d ^= c[i] && _seq[k-i];
+            if(!d) { ++m; continue; }
+            for(int i = 0; i <= n; ++i) t[i] = c[i];
+            for(int i = 0; i + m <= n; ++i) c[i+m] ^= b[i];
+            if(2 * l <= k)
+            {
+                l = k + 1 - l;
+                for(int i = 0; i <= n; ++i) b[i] = t[i];
+                m = 1;
+            } else ++m;
+        }
+        eiAssert(l == _degree, "Unexpected linear complexity of the generator.");
+        // The characteristic polynomial is the reciprocal of the connection polynomial.
+        Gf2Poly512 p;
+        for(int i = 0; i <= l; ++i)
+            if(c[i]) p.flip(l - i);
+        return p;
+    }
+
+
     Xorshift32Rng::Xorshift32Rng(ei::uint32 _seed) :
         state(_seed)
     {
     }
 
+    static inline ei::uint32 xorshift32Step(ei::uint32& _state)
+    {
+        _state ^= _state << 13;
+        _state ^= _state >> 17;
+        _state ^= _state << 5;
+        return _state;
+    }
+
     ei::uint32 Xorshift32Rng::operator () ()
     {
-        state ^= state << 13;
-        state ^= state >> 17;
-        state ^= state << 5;
-        return state;
+        return xorshift32Step(state);
+    }
+
+    void Xorshift32Rng::fill(ei::uint32* _out, size_t _n)
+    {
+        ei::uint32 s = state;
+        for(size_t i = 0; i < _n; ++i)
+            _out[i] = xorshift32Step(s);
+        state = s;
+    }
+
+    void Xorshift32Rng::fill(ei::uint64* _out, size_t _n)
+    {
+        fill64(*this, _out, _n);
+    }
+
+    static Gf2Matrix32 xorshift32Matrix()
+    {
+        Gf2Matrix32 m;
+        for(int j = 0; j < 32; ++j)
+        {
+            ei::uint32 x = 1u << j;
+            m.col[j] = xorshift32Step(x);
+        }
+        return m;
+    }
+
+    void Xorshift32Rng::discard(ei::uint64 _n)
+    {
+        state = gf2Power(xorshift32Matrix(), _n, state);
+    }
+
+    void Xorshift32Rng::jump()
+    {
+        static const Gf2Matrix32 JUMP = []() {
+            Gf2Matrix32 m = xorshift32Matrix();
+            for(int i = 0; i < 24; ++i) m = m * m;
+            return m;
+        }();
+        state = JUMP.apply(state);
     }
 
 
@@ -25,26 +215,45 @@ namespace cn {
         state[1] = _seed * 0x120287B46240898C;
     }
 
-    ei::uint32 Rule30CARng::operator () ()
+    static inline ei::uint32 rule30Step(ei::uint64& _s0, ei::uint64& _s1)
     {
         // Somehow recover from full zero-state
-        if(state[0] == 0) state[0] = 0x00100000000010000 ^ state[1];
-        if(state[1] == 0) state[1] = 0x00000100000000100 ^ state[0];
+        if(_s0 == 0) _s0 = 0x00100000000010000 ^ _s1;
+        if(_s1 == 0) _s1 = 0x00000100000000100 ^ _s0;
 
         // Each state variable is handled as 61 bit shift register.
-        ei::uint64 ap = (state[0] << 1) | ((state[0] >> 60) & 1);
-        ei::uint64 an = ((state[0] >> 1) & 0x1fffffffffffffff) | (state[0] << 60);
-        state[0] = ap ^ (state[0] | an);
-        ap = (state[1] << 1) | ((state[1] >> 60) & 1);
-        an = ((state[1] >> 1) & 0x1fffffffffffffff) | (state[1] << 60);
-        state[1] = ap ^ (state[1] | an);
+        ei::uint64 ap = (_s0 << 1) | ((_s0 >> 60) & 1);
+        ei::uint64 an = ((_s0 >> 1) & 0x1fffffffffffffff) | (_s0 << 60);
+        _s0 = ap ^ (_s0 | an);
+        ap = (_s1 << 1) | ((_s1 >> 60) & 1);
+        an = ((_s1 >> 1) & 0x1fffffffffffffff) | (_s1 << 60);
+        _s1 = ap ^ (_s1 | an);
 
         // Extract 32 bits from the 122 possible bits.
-        ei::uint64 x = (state[0] & 0x2111211112122112) | (state[1] & 0x1222122221211221);
+        ei::uint64 x = (_s0 & 0x2111211112122112) | (_s1 & 0x1222122221211221);
         // Now the pattern of x is 00xx 00xx. Pack that together...
         return ei::uint32(x | (x >> 30));
     }
 
+    ei::uint32 Rule30CARng::operator () ()
+    {
+        return rule30Step(state[0], state[1]);
+    }
+
+    void Rule30CARng::fill(ei::uint32* _out, size_t _n)
+    {
+        ei::uint64 s0 = state[0], s1 = state[1];
+        for(size_t i = 0; i < _n; ++i)
+            _out[i] = rule30Step(s0, s1);
+        state[0] = s0;
+        state[1] = s1;
+    }
+
+    void Rule30CARng::fill(ei::uint64* _out, size_t _n)
+    {
+        fill64(*this, _out, _n);
+    }
+
 
 
     MwcRng::MwcRng(ei::uint32 _seed)
@@ -53,11 +262,65 @@ namespace cn {
         state[1] = WangHash()(_seed + 0x100001);
     }
 
+    static inline ei::uint32 mwcStep(ei::uint32& _s0, ei::uint32& _s1)
+    {
+        _s0 = 36969 * (_s0 & 65535) + (_s0 >> 16);
+        _s1 = 18000 * (_s1 & 65535) + (_s1 >> 16);
+        return (_s0 << 16) + _s1;
+    }
+
     ei::uint32 MwcRng::operator()()
     {
-        state[0] = 36969 * (state[0] & 65535) + (state[0] >> 16);
-        state[1] = 18000 * (state[1] & 65535) + (state[1] >> 16);
-        return (state[0] << 16) + state[1];
+        return mwcStep(state[0], state[1]);
+    }
+
+    void MwcRng::fill(ei::uint32* _out, size_t _n)
+    {
+        ei::uint32 s0 = state[0], s1 = state[1];
+        for(size_t i = 0; i < _n; ++i)
+            _out[i] = mwcStep(s0, s1);
+        state[0] = s0;
+        state[1] = s1;
+    }
+
+    void MwcRng::fill(ei::uint64* _out, size_t _n)
+    {
+        fill64(*this, _out, _n);
+    }
+
+    // Advance one lag-1 MWC generator with base 2^16 by _n steps.
+    // The state s = c*2^16 + x maps to a*x + c which is congruent to a*s
+    // modulo m = a*2^16-1. Once s <= m this holds for all following states.
+    static ei::uint32 mwcAdvance(ei::uint32 _s, ei::uint32 _a, ei::uint64 _n)
+    {
+        const ei::uint64 m = ei::uint64(_a) * 65536 - 1;
+        // Seeds above m need a few regular steps first
+        while(_n > 0 && _s > m)
+        {
+            _s = _a * (_s & 65535) + (_s >> 16);
+            --_n;
+        }
+        // Fixed points (m and 0) are not changed
+        if(_s == m) return _s;
+        ei::uint64 f = 1, b = _a;
+        while(_n)
+        {
+            if(_n & 1) f = (f * b) % m;
+            b = (b * b) % m;
+            _n >>= 1;
+        }
+        return ei::uint32((f * _s) % m);
+    }
+
+    void MwcRng::discard(ei::uint64 _n)
+    {
+        state[0] = mwcAdvance(state[0], 36969, _n);
+        state[1] = mwcAdvance(state[1], 18000, _n);
+    }
+
+    void MwcRng::jump()
+    {
+        discard(1ull << 24);
     }
 
 
@@ -72,16 +335,16 @@ namespace cn {
             operator()();
     }
 
-    ei::uint32 CmwcRng::operator () ()
+    static inline ei::uint32 cmwcStep(ei::uint32* _state, ei::uint32& _counter, ei::uint32& _carry, ei::uint32 _lagMask)
     {
         ei::uint64 t = 0;
         //const uint64 a = 18782;       // as Marsaglia recommends
         const ei::uint64 a = 41305945;       // deterimend from the rule a*b^lag + 1 = prime with b^lag = 2^(32*4)
         ei::uint32 x = 0;
 
-        counter = (counter + 1) & (LAG - 1);
-        t = a * state[counter] + carry;
-        carry = t >> 32;
+        _counter = (_counter + 1) & _lagMask;
+        t = a * _state[_counter] + _carry;
+        _carry = t >> 32;
         /*x = t + carry;
         if (x < carry)
         {
@@ -90,7 +353,41 @@ namespace cn {
         }*/
         x = (ei::uint32)t;
 
-        return state[counter] = 0xfffffffe - x;
+        return _state[_counter] = 0xfffffffe - x;
+    }
+
+    ei::uint32 CmwcRng::operator () ()
+    {
+        return cmwcStep(state, counter, carry, LAG - 1);
+    }
+
+    void CmwcRng::fill(ei::uint32* _out, size_t _n)
+    {
+        ei::uint32 s[LAG];
+        for(int i = 0; i < LAG; ++i) s[i] = state[i];
+        ei::uint32 c = counter, cy = carry;
+        for(size_t i = 0; i < _n; ++i)
+            _out[i] = cmwcStep(s, c, cy, LAG - 1);
+        for(int i = 0; i < LAG; ++i) state[i] = s[i];
+        counter = c;
+        carry = cy;
+    }
+
+    void CmwcRng::fill(ei::uint64* _out, size_t _n)
+    {
+        fill64(*this, _out, _n);
+    }
+
+    void CmwcRng::discard(ei::uint64 _n)
+    {
+        ei::uint32 s[LAG];
+        for(int i = 0; i < LAG; ++i) s[i] = state[i];
+        ei::uint32 c = counter, cy = carry;
+        for(ei::uint64 i = 0; i < _n; ++i)
+            cmwcStep(s, c, cy, LAG - 1);
+        for(int i = 0; i < LAG; ++i) state[i] = s[i];
+        counter = c;
+        carry = cy;
     }
 
 
@@ -106,18 +403,90 @@ namespace cn {
         while(state[3] <= 127) state[0] = WangHash()(state[3] + 1);
     }
 
-    ei::uint32 Lfsr113Rng::operator () ()
+    static inline ei::uint32 lfsr113Step(ei::uint32& _z0, ei::uint32& _z1, ei::uint32& _z2, ei::uint32& _z3)
     {
         ei::uint32 b;
-        b = (((state[0] << 6) ^ state[0]) >> 13);
-        state[0] = (((state[0] & 4294967294) << 18) ^ b);
-        b = (((state[1] << 2) ^ state[1]) >> 27);
-        state[1] = (((state[1] & 4294967288) << 2) ^ b);
-        b = (((state[2] << 13) ^ state[2]) >> 21);
-        state[2] = (((state[2] & 4294967280) << 7) ^ b);
-        b = (((state[3] << 3) ^ state[3]) >> 12);
-        state[3] = (((state[3] & 4294967168) << 13) ^ b);
-        return state[0] ^ state[1] ^ state[2] ^ state[3];
+        b = (((_z0 << 6) ^ _z0) >> 13);
+        _z0 = (((_z0 & 4294967294) << 18) ^ b);
+        b = (((_z1 << 2) ^ _z1) >> 27);
+        _z1 = (((_z1 & 4294967288) << 2) ^ b);
+        b = (((_z2 << 13) ^ _z2) >> 21);
+        _z2 = (((_z2 & 4294967280) << 7) ^ b);
+        b = (((_z3 << 3) ^ _z3) >> 12);
+        _z3 = (((_z3 & 4294967168) << 13) ^ b);
+        return _z0 ^ _z1 ^ _z2 ^ _z3;
+    }
+
+    ei::uint32 Lfsr113Rng::operator () ()
+    {
+        return lfsr113Step(state[0], state[1], state[2], state[3]);
+    }
+
+    void Lfsr113Rng::fill(ei::uint32* _out, size_t _n)
+    {
+        ei::uint32 z0 = state[0], z1 = state[1], z2 = state[2], z3 = state[3];
+        for(size_t i = 0; i < _n; ++i)
+            _out[i] = lfsr113Step(z0, z1, z2, z3);
+        state[0] = z0;
+        state[1] = z1;
+        state[2] = z2;
+        state[3] = z3;
+    }
+
+    void Lfsr113Rng::fill(ei::uint64* _out, size_t _n)
+    {
+        fill64(*this, _out, _n);
+    }
+
+    // The four components are independent linear maps. The matrix of
+    // component _c is obtained by stepping unit vectors in that component.
+    static Gf2Matrix32 lfsr113Matrix(int _c)
+    {
+        Gf2Matrix32 m;
+        for(int j = 0; j < 32; ++j)
+        {
+            ei::uint32 z[4] = {0, 0, 0, 0};
+            z[_c] = 1u << j;
+            lfsr113Step(z[0], z[1], z[2], z[3]);
+            m.col[j] = z[_c];
+        }
+        return m;
+    }
+
+    void Lfsr113Rng::discard(ei::uint64 _n)
+    {
+        for(int c = 0; c < 4; ++c)
+            state[c] = gf2Power(lfsr113Matrix(c), _n, state[c]);
+    }
+
+    // Matrices of the four components for 2^64 steps.
+    struct Lfsr113JumpMatrices { Gf2Matrix32 m[4]; };
+    static const Lfsr113JumpMatrices& lfsr113JumpMatrices()
+    {
+        static const Lfsr113JumpMatrices JUMP = []() {
+            Lfsr113JumpMatrices j;
+            for(int c = 0; c < 4; ++c)
+            {
+                j.m[c] = lfsr113Matrix(c);
+                for(int i = 0; i < 64; ++i) j.m[c] = j.m[c] * j.m[c];
+            }
+            return j;
+        }();
+        return JUMP;
+    }
+
+    void Lfsr113Rng::jump()
+    {
+        const Lfsr113JumpMatrices& jump = lfsr113JumpMatrices();
+        for(int c = 0; c < 4; ++c)
+            state[c] = jump.m[c].apply(state[c]);
+    }
+
+    void Lfsr113Rng::jump(ei::uint64 _count)
+    {
+        const Lfsr113JumpMatrices& jump = lfsr113JumpMatrices();
+        for(int c = 0; c < 4; ++c)
+            state[c] = gf2Power(jump.m[c], _count, state[c]);
     }
 
 
@@ -129,194 +498,1198 @@ namespace cn {
             state[i] = WangHash()(_seed + i);
     }
 
-    ei::uint32 Well512Rng::operator () ()
+    static inline ei::uint32 well512Step(ei::uint32* _state, ei::uint32& _counter)
     {
         ei::uint32 a, b, c, d;
-        a = state[counter];
-        c = state[(counter + 13) & 15];
+        a = _state[_counter];
+        c = _state[(_counter + 13) & 15];
         b = a ^ c ^ (a<<16) ^ (c<<15);
-        c = state[(counter + 9) & 15];
+        c = _state[(_counter + 9) & 15];
         c ^= (c>>11);
-        a = state[counter] = b^c;
+        a = _state[_counter] = b^c;
         d = a ^ ((a<<5) & 0xDA442D24);
-        counter = (counter + 15) & 15;
-        a = state[counter];
-        state[counter] = a ^ b ^ d ^ (a<<2) ^ (b<<18) ^ (c<<28);
-        return state[counter];
+        _counter = (_counter + 15) & 15;
+        a = _state[_counter];
+        _state[_counter] = a ^ b ^ d ^ (a<<2) ^ (b<<18) ^ (c<<28);
+        return _state[_counter];
     }
 
-
-
-    static const int PRIMES[32] = {
-        2, 3, 5, 7, 11, 13, 17, 19,
-        23, 29, 31, 37, 41, 43, 47, 53,
-        59, 61, 67, 71, 73, 79, 83, 89,
-        97, 101, 103, 107, 109, 113, 127, 131
-    };
-
-    HaltonRng::HaltonRng(ei::uint32 _numBases) :
-        numBases(_numBases),
-        counter(_numBases) // Skip all the 0 entries
+    ei::uint32 Well512Rng::operator () ()
     {
+        return well512Step(state, counter);
     }
 
-    ei::uint32 HaltonRng::operator () ()
+    void Well512Rng::fill(ei::uint32* _out, size_t _n)
     {
-        ei::uint32 base = PRIMES[counter % numBases];
-        ei::uint32 i = counter / numBases;
-        ei::uint32 result = 0;
-        ei::uint32 f = ei::uint32(0x100000000ull / base);
-        while(i > 0)
-        {
-            result += f * (i % base);
-            i /= base;
-            f /= base;
-        }
-        ++counter;
-        return result;
+        ei::uint32 s[16];
+        for(int i = 0; i < 16; ++i) s[i] = state[i];
+        ei::uint32 c = counter;
+        for(size_t i = 0; i < _n; ++i)
+            _out[i] = well512Step(s, c);
+        for(int i = 0; i < 16; ++i) state[i] = s[i];
+        counter = c;
     }
 
+    void Well512Rng::fill(ei::uint64* _out, size_t _n)
+    {
+        fill64(*this, _out, _n);
+    }
 
-    HaltonRevRng::HaltonRevRng(ei::uint32 _numBases) :
-        numBases(_numBases),
-        counter(_numBases) // Skip all the 0 entries
+    // Characteristic polynomial of the Well512 transition (from the lowest
+    // output bit).
+    static const Gf2Poly512& well512CharPoly()
     {
+        static const Gf2Poly512 POLY = []() {
+            bool seq[1024];
+            Well512Rng gen(1);
+            for(int i = 0; i < 1024; ++i) seq[i] = gen() & 1;
+            return gf2CharPoly(seq, 512);
+        }();
+        return POLY;
     }
 
-    static ei::uint32 reversePermutation(ei::uint32 i, ei::uint32 b) { return i==0 ? 0 : b-i; }
-    ei::uint32 HaltonRevRng::operator () ()
+    // Compute the new state as sum of q_i T^i state where q = x^n mod P.
+    static void well512Apply(ei::uint32* _state, ei::uint32& _counter, const Gf2Poly512& _q)
     {
-        ei::uint32 base = PRIMES[counter % numBases];
-        ei::uint32 i = counter / numBases;
-        ei::uint32 result = 0;
-        ei::uint32 f = ei::uint32(0x100000000ull / base);
-        while(i > 0)
+        ei::uint32 acc[16] = {0};
+        ei::uint32 s[16];
+        for(int i = 0; i < 16; ++i) s[i] = _state[i];
+        ei::uint32 c = _counter;
+        for(int i = 0; i < 512; ++i)
         {
-            result += f * reversePermutation(i % base, base);
-            i /= base;
-            f /= base;
+            // Accumulate in counter relative order, because the transition is
+            // linear in that representation.
+            if(_q.coeff(i))
+                for(int j = 0; j < 16; ++j) acc[j] ^= s[(c + j) & 15];
+            well512Step(s, c);
         }
-        ++counter;
-        return result;
+        for(int j = 0; j < 16; ++j) _state[(_counter + j) & 15] = acc[j];
     }
 
+    void Well512Rng::discard(ei::uint64 _n)
+    {
+        const Gf2Poly512& p = well512CharPoly();
+        // Left-to-right binary exponentiation of x
+        Gf2Poly512 q, x;
+        q.flip(0);
+        x.flip(1);
+        for(int i = 63; i >= 0; --i)
+        {
+            q = gf2MulMod(q, q, p);
+            if((_n >> i) & 1) q = gf2MulMod(q, x, p);
+        }
+        well512Apply(state, counter, q);
+    }
 
-    // Bases are computed as (2^32-1) * frac(sqrt(<Prime>))
-    const ei::uint32 AdditiveRecurrenceRng::BASES[8] = {
-                                2654435769, 1779033704, 3144134277, 1013904243,
-                                2773480762, 1359893119, 2600822924,  528734636};
+    // x^(2^256) mod P
+    static const Gf2Poly512& well512JumpPoly()
+    {
+        static const Gf2Poly512 JUMP = []() {
+            const Gf2Poly512& p = well512CharPoly();
+            Gf2Poly512 q;
+            q.flip(1);
+            for(int i = 0; i < 256; ++i)
+                q = gf2MulMod(q, q, p);
+            return q;
+        }();
+        return JUMP;
+    }
 
-    AdditiveRecurrenceRng::AdditiveRecurrenceRng(ei::uint32 _numBases) :
-        numBases(_numBases),
-        counter(0)
+    void Well512Rng::jump()
     {
+        well512Apply(state, counter, well512JumpPoly());
     }
 
-    ei::uint32 AdditiveRecurrenceRng::operator () ()
+    void Well512Rng::jump(ei::uint64 _count)
     {
-        ei::uint32 base = BASES[counter % numBases];
-        ei::uint32 i = counter / numBases;
-        ++counter;
-        return base * i;
+        well512Apply(state, counter, gf2PowMod(well512JumpPoly(), _count, well512CharPoly()));
     }
 
 
-    const int HammersleyRng::BASES[8] = {0, 2, 3, 5, 7, 11, 13, 17};
 
-    HammersleyRng::HammersleyRng(ei::uint32 _numBases, ei::uint32 _numSamples) :
-        numBases(_numBases),
-        numSamples(_numSamples),
-        counter(0)
+    // Bulk generation for the 64 bit generators: the 32 bit version takes the
+    // upper halves.
+    template<typename RndGen>
+    static void fill32From64(RndGen& _generator, ei::uint32* _out, size_t _n)
     {
+        for(size_t i = 0; i < _n; ++i)
+            _out[i] = ei::uint32(_generator.next64() >> 32);
     }
 
-    ei::uint32 HammersleyRng::operator () ()
+    static inline ei::uint64 rotl64(ei::uint64 _x, int _k)
     {
-        ei::uint32 base = BASES[counter % numBases];
-        ei::uint32 i = counter++ / numBases;
-        // First dimension is n/N
-        if(base == 0)
-            return ei::uint32((ei::uint64(i) * (1ull<<32)) / numSamples);
-        // All others are Halton sequences
-        ei::uint32 result = 0;
-        ei::uint32 f = ei::uint32(0x100000000ull / base);
-        while(i > 0)
-        {
-            result += f * (i % base);
-            i /= base;
-            f /= base;
-        }
-        return result;
+        return (_x << _k) | (_x >> (64 - _k));
     }
 
+    Xoshiro256Rng::Xoshiro256Rng(ei::uint64 _seed)
+    {
+        Splitmix64Rng seeder(_seed);
+        for(int i = 0; i < 4; ++i)
+            state[i] = seeder.next64();
+    }
 
-    ei::uint32 KnuthHash::operator () (ei::uint32 _x) const
+    static inline ei::uint64 xoshiro256Step(ei::uint64* _s)
     {
-        return _x * 2654435761;
+        ei::uint64 result = rotl64(_s[1] * 5, 7) * 9;
+        ei::uint64 t = _s[1] << 17;
+        _s[2] ^= _s[0];
+        _s[3] ^= _s[1];
+        _s[1] ^= _s[2];
+        _s[0] ^= _s[3];
+        _s[2] ^= t;
+        _s[3] = rotl64(_s[3], 45);
+        return result;
     }
 
-    ei::uint32 WangHash::operator () (ei::uint32 _x) const
+    ei::uint64 Xoshiro256Rng::next64()
     {
-        _x = (_x ^ 61) ^ (_x >> 16);
-        _x *= 9;
-        _x = _x ^ (_x >> 4);
-        _x *= 0x27d4eb2d;
-        _x = _x ^ (_x >> 15);
-        return _x;
-		// 2007 variant: https://gist.github.com/badboy/6267743
-		/*_x = ~_x + (_x << 15); // _x = (_x << 15) - _x - 1;
-		_x = _x ^ (_x >> 12);
-		_x = _x + (_x << 2);
-		_x = _x ^ (_x >> 4);
-		_x = _x * 2057; // _x = (_x + (_x << 3)) + (_x << 11);
-		_x = _x ^ (_x >> 16);
-		return _x;*/
+        return xoshiro256Step(state);
     }
 
-    ei::uint32 JenkinsHash::operator () (ei::uint32 _x) const
+    void Xoshiro256Rng::fill(ei::uint32* _out, size_t _n)
     {
-        _x = (_x + 0x7ed55d16) + (_x << 12);
-        _x = (_x ^ 0xc761c23c) ^ (_x >> 19);
-        _x = (_x + 0x165667b1) + (_x << 5);
-        _x = (_x + 0xd3a2646c) ^ (_x << 9);
-        _x = (_x + 0xfd7046c5) + (_x << 3);
-        _x = (_x ^ 0xb55a4f09) ^ (_x >> 16);
-        return _x;
+        ei::uint64 s[4] = {state[0], state[1], state[2], state[3]};
+        for(size_t i = 0; i < _n; ++i)
+            _out[i] = ei::uint32(xoshiro256Step(s) >> 32);
+        for(int i = 0; i < 4; ++i) state[i] = s[i];
     }
 
-    ei::uint32 Murmur32Hash::operator () (ei::uint32 _x) const
+    void Xoshiro256Rng::fill(ei::uint64* _out, size_t _n)
     {
-        _x ^= _x >> 16;
-        _x *= 0x85ebca6bu;
-        _x ^= _x >> 13;
-        _x *= 0xc2b2ae35u;
-        _x ^= _x >> 16;
-        return _x;
+        ei::uint64 s[4] = {state[0], state[1], state[2], state[3]};
+        for(size_t i = 0; i < _n; ++i)
+            _out[i] = xoshiro256Step(s);
+        for(int i = 0; i < 4; ++i) state[i] = s[i];
     }
 
-    ei::uint32 ProspectorHash::operator () (ei::uint32 _x) const
+    // Characteristic polynomial of the xoshiro256 transition (from the lowest
+    // bit of the first state word).
+    static const Gf2Poly512& xoshiro256CharPoly()
     {
-        _x ^= _x >> 16;
-        _x *= 0x7feb352du;
-        _x ^= _x >> 15;
-        _x *= 0x846ca68bu;
-        _x ^= _x >> 16;
-        return _x;
+        static const Gf2Poly512 POLY = []() {
+            bool seq[512];
+            ei::uint64 s[4] = {1, 2, 3, 4};
+            for(int i = 0; i < 512; ++i)
+            {
+                seq[i] = s[0] & 1;
+                xoshiro256Step(s);
+            }
+            return gf2CharPoly(seq, 256);
+        }();
+        return POLY;
     }
 
-    ei::uint32 ProspectorXHash::operator () (ei::uint32 _x) const
+    // Compute the new state as sum of q_i T^i state.
+    static void xoshiro256Apply(ei::uint64* _state, const Gf2Poly512& _q)
     {
-        _x ^= _x >> 17;
-        _x *= 0xed5ad4bbu;
-        _x ^= _x >> 11;
-        _x *= 0xac4c1b51u;
-        _x ^= _x >> 15;
-        _x *= 0x31848babu;
-        _x ^= _x >> 14;
-        return _x;
+        ei::uint64 s[4] = {0, 0, 0, 0};
+        for(int i = 0; i < 256; ++i)
+        {
+            if(_q.coeff(i))
+                for(int j = 0; j < 4; ++j) s[j] ^= _state[j];
+            xoshiro256Step(_state);
+        }
+        for(int i = 0; i < 4; ++i) _state[i] = s[i];
     }
 
-    ei::uint64 Splitmix64Hash::operator () (ei::uint64 _x) const
+    // Jump polynomial of the authors (x^(2^128) mod P).
+    static Gf2Poly512 xoshiro256JumpPoly()
+    {
+        Gf2Poly512 q;
+        q.w[0] = 0x180ec6d33cfd0abaull;
+        q.w[1] = 0xd5a61266f0c9392cull;
+        q.w[2] = 0xa9582618e03fc9aaull;
+        q.w[3] = 0x39abdc4529b1661cull;
+        return q;
+    }
+
+    void Xoshiro256Rng::jump()
+    {
+        xoshiro256Apply(state, xoshiro256JumpPoly());
+    }
+
+    void Xoshiro256Rng::jump(ei::uint64 _count)
+    {
+        xoshiro256Apply(state, gf2PowMod(xoshiro256JumpPoly(), _count, xoshiro256CharPoly(), 256));
+    }
+
+    // Portable 128 bit arithmetic for the PCG64 LCG. The words are stored as
+    // [low, high].
+    static inline void mul64(ei::uint64 _a, ei::uint64 _b, ei::uint64& _hi, ei::uint64& _lo)
+    {
+#ifdef __SIZEOF_INT128__
+        unsigned __int128 p = (unsigned __int128)_a * _b;
+        _hi = ei::uint64(p >> 64);
+        _lo = ei::uint64(p);
+#else
+        ei::uint64 a0 = _a & 0xffffffff, a1 = _a >> 32;
+        ei::uint64 b0 = _b & 0xffffffff, b1 = _b >> 32;
+        ei::uint64 p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+        ei::uint64 mid = (p00 >> 32) + (p01 & 0xffffffff) + (p10 & 0xffffffff);
+        _lo = (mid << 32) | (p00 & 0xffffffff);
+        _hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+#endif
+    }
+
+    // _r = _a * _b (mod 2^128)
+    static inline void mul128(const ei::uint64* _a, const ei::uint64* _b, ei::uint64* _r)
+    {
+        ei::uint64 hi, lo;
+        mul64(_a[0], _b[0], hi, lo);
+        hi += _a[0] * _b[1] + _a[1] * _b[0];
+        _r[0] = lo;
+        _r[1] = hi;
+    }
+
+    // _r = _a + _b (mod 2^128)
+    static inline void add128(const ei::uint64* _a, const ei::uint64* _b, ei::uint64* _r)
+    {
+        ei::uint64 lo = _a[0] + _b[0];
+        _r[1] = _a[1] + _b[1] + (lo < _a[0] ? 1 : 0);
+        _r[0] = lo;
+    }
+
+    static const ei::uint64 PCG64_MULTIPLIER[2] = {0x4385df649fccf645ull, 0x2360ed051fc65da4ull};
+
+    static inline ei::uint64 pcg64Step(ei::uint64* _state, const ei::uint64* _increment)
+    {
+        mul128(_state, PCG64_MULTIPLIER, _state);
+        add128(_state, _increment, _state);
+        // XSL-RR output
+        int rot = int(_state[1] >> 58);
+        ei::uint64 x = _state[1] ^ _state[0];
+        return (x >> rot) | (x << ((64 - rot) & 63));
+    }
+
+    Pcg64Rng::Pcg64Rng(ei::uint64 _seed, ei::uint64 _stream)
+    {
+        // Same initialization as the reference pcg64 with 128 bit arguments
+        // (seed, stream).
+        increment[0] = (_stream << 1) | 1;
+        increment[1] = _stream >> 63;
+        state[0] = state[1] = 0;
+        pcg64Step(state, increment);
+        ei::uint64 seed[2] = {_seed, 0};
+        add128(state, seed, state);
+        pcg64Step(state, increment);
+    }
+
+    ei::uint64 Pcg64Rng::next64()
+    {
+        return pcg64Step(state, increment);
+    }
+
+    void Pcg64Rng::fill(ei::uint32* _out, size_t _n)
+    {
+        fill32From64(*this, _out, _n);
+    }
+
+    void Pcg64Rng::fill(ei::uint64* _out, size_t _n)
+    {
+        ei::uint64 s[2] = {state[0], state[1]};
+        for(size_t i = 0; i < _n; ++i)
+            _out[i] = pcg64Step(s, increment);
+        state[0] = s[0];
+        state[1] = s[1];
+    }
+
+    void Pcg64Rng::discard(ei::uint64 _n)
+    {
+        // The LCG step applied n times is again an affine map x -> A*x + C
+        // which is built by square and multiply (F. B. Brown "Random Number
+        // Generation with Arbitrary Strides").
+        ei::uint64 accMul[2] = {1, 0}, accAdd[2] = {0, 0};
+        ei::uint64 curMul[2] = {PCG64_MULTIPLIER[0], PCG64_MULTIPLIER[1]};
+        ei::uint64 curAdd[2] = {increment[0], increment[1]};
+        const ei::uint64 ONE[2] = {1, 0};
+        while(_n > 0)
+        {
+            if(_n & 1)
+            {
+                mul128(accMul, curMul, accMul);
+                mul128(accAdd, curMul, accAdd);
+                add128(accAdd, curAdd, accAdd);
+            }
+            ei::uint64 t[2];
+            add128(curMul, ONE, t);
+            mul128(t, curAdd, curAdd);
+            mul128(curMul, curMul, curMul);
+            _n >>= 1;
+        }
+        mul128(accMul, state, state);
+        add128(state, accAdd, state);
+    }
+
+    Splitmix64Rng::Splitmix64Rng(ei::uint64 _seed) :
+        state(_seed)
+    {
+    }
+
+    ei::uint64 Splitmix64Rng::next64()
+    {
+        state += 0x9e3779b97f4a7c15ull;
+        return Splitmix64Hash()(state);
+    }
+
+    void Splitmix64Rng::fill(ei::uint32* _out, size_t _n)
+    {
+        fill32From64(*this, _out, _n);
+    }
+
+    void Splitmix64Rng::fill(ei::uint64* _out, size_t _n)
+    {
+        Splitmix64Hash hash;
+        ei::uint64 s = state;
+        for(size_t i = 0; i < _n; ++i)
+        {
+            s += 0x9e3779b97f4a7c15ull;
+            _out[i] = hash(s);
+        }
+        state = s;
+    }
+
+    void Splitmix64Rng::discard(ei::uint64 _n)
+    {
+        state += _n * 0x9e3779b97f4a7c15ull;
+    }
+
+
+
+    // Lane primitives for the multi-lane generators. Each specialization
+    // processes W lanes at once. The single lane version is the scalar
+    // fallback.
+    template<int W> struct LaneOps;
+
+    template<> struct LaneOps<1>
+    {
+        typedef ei::uint32 V;
+        static V load(const ei::uint32* _p) { return *_p; }
+        static void store(ei::uint32* _p, V _x) { *_p = _x; }
+        static V splat(ei::uint32 _x) { return _x; }
+        static V bxor(V _a, V _b) { return _a ^ _b; }
+        static V band(V _a, V _b) { return _a & _b; }
+        template<int K> static V shl(V _x) { return _x << K; }
+        template<int K> static V shr(V _x) { return _x >> K; }
+    };
+
+#ifdef CN_HAS_SSE2
+    template<> struct LaneOps<4>
+    {
+        typedef __m128i V;
+        static V load(const ei::uint32* _p) { return _mm_load_si128(reinterpret_cast<const __m128i*>(_p)); }
+        static void store(ei::uint32* _p, V _x) { _mm_storeu_si128(reinterpret_cast<__m128i*>(_p), _x); }
+        static V splat(ei::uint32 _x) { return _mm_set1_epi32(int(_x)); }
+        static V bxor(V _a, V _b) { return _mm_xor_si128(_a, _b); }
+        static V band(V _a, V _b) { return _mm_and_si128(_a, _b); }
+        template<int K> static V shl(V _x) { return _mm_slli_epi32(_x, K); }
+        template<int K> static V shr(V _x) { return _mm_srli_epi32(_x, K); }
+    };
+#endif
+
+#ifdef __AVX2__
+    template<> struct LaneOps<8>
+    {
+        typedef __m256i V;
+        static V load(const ei::uint32* _p) { return _mm256_load_si256(reinterpret_cast<const __m256i*>(_p)); }
+        static void store(ei::uint32* _p, V _x) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(_p), _x); }
+        static V splat(ei::uint32 _x) { return _mm256_set1_epi32(int(_x)); }
+        static V bxor(V _a, V _b) { return _mm256_xor_si256(_a, _b); }
+        static V band(V _a, V _b) { return _mm256_and_si256(_a, _b); }
+        template<int K> static V shl(V _x) { return _mm256_slli_epi32(_x, K); }
+        template<int K> static V shr(V _x) { return _mm256_srli_epi32(_x, K); }
+    };
+    // Number of lanes processed at once for the 8 lane generators
+    enum { LANE8_WIDTH = 8 };
+#elif defined(CN_HAS_SSE2)
+    enum { LANE8_WIDTH = 4 };
+#else
+    enum { LANE8_WIDTH = 1 };
+#endif
+
+    // Number of lanes processed at once for the 4 lane generators
+#ifdef CN_HAS_SSE2
+    enum { LANE4_WIDTH = 4 };
+#else
+    enum { LANE4_WIDTH = 1 };
+#endif
+
+    // Advance the lanes [0, W) of the given state pointers.
+    template<int W>
+    static inline void xorshift32Lanes(ei::uint32* _state, ei::uint32* _out)
+    {
+        typedef LaneOps<W> L;
+        typedef typename L::V V;
+        V s = L::load(_state);
+        s = L::bxor(s, L::template shl<13>(s));
+        s = L::bxor(s, L::template shr<17>(s));
+        s = L::bxor(s, L::template shl<5>(s));
+        L::store(_state, s);
+        L::store(_out, s);
+    }
+
+    // _z: pointer to the first lane of the first component. Components have a
+    //     distance of 8 lanes.
+    template<int W>
+    static inline void lfsr113Lanes(ei::uint32* _z, ei::uint32* _out)
+    {
+        typedef LaneOps<W> L;
+        typedef typename L::V V;
+        V z0 = L::load(_z), z1 = L::load(_z + 8), z2 = L::load(_z + 16), z3 = L::load(_z + 24);
+        V b;
+        b = L::template shr<13>(L::bxor(L::template shl<6>(z0), z0));
+        z0 = L::bxor(L::template shl<18>(L::band(z0, L::splat(4294967294))), b);
+        b = L::template shr<27>(L::bxor(L::template shl<2>(z1), z1));
+        z1 = L::bxor(L::template shl<2>(L::band(z1, L::splat(4294967288))), b);
+        b = L::template shr<21>(L::bxor(L::template shl<13>(z2), z2));
+        z2 = L::bxor(L::template shl<7>(L::band(z2, L::splat(4294967280))), b);
+        b = L::template shr<12>(L::bxor(L::template shl<3>(z3), z3));
+        z3 = L::bxor(L::template shl<13>(L::band(z3, L::splat(4294967168))), b);
+        L::store(_z, z0); L::store(_z + 8, z1); L::store(_z + 16, z2); L::store(_z + 24, z3);
+        L::store(_out, L::bxor(L::bxor(z0, z1), L::bxor(z2, z3)));
+    }
+
+    // _state: pointer to the first lane of the first word. Words have a
+    //     distance of 4 lanes.
+    template<int W>
+    static inline void well512Lanes(ei::uint32* _state, ei::uint32 _counter, ei::uint32* _out)
+    {
+        typedef LaneOps<W> L;
+        typedef typename L::V V;
+        V a, b, c, d;
+        a = L::load(_state + _counter * 4);
+        c = L::load(_state + ((_counter + 13) & 15) * 4);
+        b = L::bxor(L::bxor(a, c), L::bxor(L::template shl<16>(a), L::template shl<15>(c)));
+        c = L::load(_state + ((_counter + 9) & 15) * 4);
+        c = L::bxor(c, L::template shr<11>(c));
+        a = L::bxor(b, c);
+        L::store(_state + _counter * 4, a);
+        d = L::bxor(a, L::band(L::template shl<5>(a), L::splat(0xDA442D24)));
+        ei::uint32 next = (_counter + 15) & 15;
+        a = L::load(_state + next * 4);
+        a = L::bxor(L::bxor(L::bxor(a, b), L::bxor(d, L::template shl<2>(a))),
+                    L::bxor(L::template shl<18>(b), L::template shl<28>(c)));
+        L::store(_state + next * 4, a);
+        L::store(_out, a);
+    }
+
+    Xorshift32x8Rng::Xorshift32x8Rng(ei::uint32 _seed)
+    {
+        for(int i = 0; i < LANES; ++i)
+        {
+            state[i] = WangHash()(_seed + i);
+            // Zero is a fixed point of the xorshift generator
+            if(state[i] == 0) state[i] = 0x6b43a9b5;
+        }
+    }
+
+    ei::Vec<ei::uint32, Xorshift32x8Rng::LANES> Xorshift32x8Rng::operator () ()
+    {
+        ei::Vec<ei::uint32, LANES> result;
+        for(int i = 0; i < LANES; i += LANE8_WIDTH)
+            xorshift32Lanes<LANE8_WIDTH>(state + i, &result[i]);
+        return result;
+    }
+
+    Lfsr113x8Rng::Lfsr113x8Rng(ei::uint32 _seed)
+    {
+        // The seed must satisfy state > [1,7,15,127]
+        const ei::uint32 MIN_STATE[4] = {1, 7, 15, 127};
+        for(int i = 0; i < LANES; ++i)
+            for(int c = 0; c < 4; ++c)
+            {
+                state[c][i] = WangHash()(_seed + 4 * i + c);
+                while(state[c][i] <= MIN_STATE[c]) state[c][i] = WangHash()(state[c][i] + 1);
+            }
+    }
+
+    ei::Vec<ei::uint32, Lfsr113x8Rng::LANES> Lfsr113x8Rng::operator () ()
+    {
+        ei::Vec<ei::uint32, LANES> result;
+        for(int i = 0; i < LANES; i += LANE8_WIDTH)
+            lfsr113Lanes<LANE8_WIDTH>(&state[0][i], &result[i]);
+        return result;
+    }
+
+    Well512x4Rng::Well512x4Rng(ei::uint32 _seed) :
+        counter(0)
+    {
+        for(int i = 0; i < LANES; ++i)
+            for(int w = 0; w < 16; ++w)
+                state[w][i] = WangHash()(_seed + 16 * i + w);
+    }
+
+    ei::Vec<ei::uint32, Well512x4Rng::LANES> Well512x4Rng::operator () ()
+    {
+        ei::Vec<ei::uint32, LANES> result;
+        for(int i = 0; i < LANES; i += LANE4_WIDTH)
+            well512Lanes<LANE4_WIDTH>(&state[0][i], counter, &result[i]);
+        counter = (counter + 15) & 15;
+        return result;
+    }
+
+
+
+    static const int PRIMES[32] = {
+        2, 3, 5, 7, 11, 13, 17, 19,
+        23, 29, 31, 37, 41, 43, 47, 53,
+        59, 61, 67, 71, 73, 79, 83, 89,
+        97, 101, 103, 107, 109, 113, 127, 131
+    };
+
+    static ei::uint32 reversePermutation(ei::uint32 i, ei::uint32 b) { return i==0 ? 0 : b-i; }
+
+    // Radical inverse engine for all Halton-like sequences.
+    // The result of a digit loop
+    //      result += f * digit; f /= base;
+    // with f starting at 2^32/base is the sum of digit_j * floor(2^32/base^(j+1)).
+    // Because of the truncation, the contribution of a group of digits depends
+    // on its position. The tables store the complete contribution of chunks of
+    // k digits for each position, such that one division by base^k and one
+    // lookup replace k iterations of the loop (with bit identical results).
+    struct RadicalInverseBase
+    {
+        // Limit for base^k to keep the tables of small bases in L1. Bases
+        // above sqrt(MAX_CHUNK_BASE) still use two digits per chunk, which
+        // gives base^2 entries per position (~1.5 MB for all bases).
+        enum { MAX_CHUNK_BASE = 1024, MIN_CHUNK_DIGITS = 2 };
+
+        ei::uint32 base;
+        bool reverse;                   // Apply reversePermutation to each digit
+        ei::uint32 chunkBase;           // base^k
+        ei::uint32 numChunks;           // Number of chunks with non-zero weights
+        ei::uint32 weight[32];          // floor(2^32 / base^(j+1)) for digit j
+        std::vector<ei::uint32> table;  // Weighted digit sums [chunk position][chunk value]
+
+        ei::uint32 digitValue(ei::uint32 _d) const { return reverse ? reversePermutation(_d, base) : _d; }
+    };
+
+    struct RadicalInverseTables
+    {
+        RadicalInverseBase bases[32];
+
+        explicit RadicalInverseTables(bool _reverse)
+        {
+            for(int p = 0; p < 32; ++p)
+            {
+                RadicalInverseBase& b = bases[p];
+                b.base = PRIMES[p];
+                b.reverse = _reverse;
+                ei::uint64 f = 0x100000000ull;
+                ei::uint32 numDigits = 0;
+                for(ei::uint32 j = 0; j < 32; ++j)
+                {
+                    f /= b.base;
+                    b.weight[j] = ei::uint32(f);
+                    if(f) numDigits = j + 1;
+                }
+                ei::uint32 k = 1;
+                b.chunkBase = b.base;
+                while(k < RadicalInverseBase::MIN_CHUNK_DIGITS
+                    || b.chunkBase * b.base <= RadicalInverseBase::MAX_CHUNK_BASE)
+                {
+                    b.chunkBase *= b.base;
+                    ++k;
+                }
+                b.numChunks = (numDigits + k - 1) / k;
+                b.table.resize(b.numChunks * b.chunkBase);
+                for(ei::uint32 pos = 0; pos < b.numChunks; ++pos)
+                    for(ei::uint32 c = 0; c < b.chunkBase; ++c)
+                    {
+                        ei::uint32 sum = 0, x = c;
+                        for(ei::uint32 t = 0; t < k && pos * k + t < 32; ++t, x /= b.base)
+                            sum += b.digitValue(x % b.base) * b.weight[pos * k + t];
+                        b.table[pos * b.chunkBase + c] = sum;
+                    }
+            }
+        }
+    };
+
+    static const RadicalInverseTables& haltonTables()
+    {
+        static const RadicalInverseTables TABLES(false);
+        return TABLES;
+    }
+
+    static const RadicalInverseTables& haltonRevTables()
+    {
+        static const RadicalInverseTables TABLES(true);
+        return TABLES;
+    }
+
+    static inline ei::uint32 reverseBits(ei::uint32 _x)
+    {
+        _x = ((_x >> 1) & 0x55555555) | ((_x & 0x55555555) << 1);
+        _x = ((_x >> 2) & 0x33333333) | ((_x & 0x33333333) << 2);
+        _x = ((_x >> 4) & 0x0f0f0f0f) | ((_x & 0x0f0f0f0f) << 4);
+        _x = ((_x >> 8) & 0x00ff00ff) | ((_x & 0x00ff00ff) << 8);
+        return (_x >> 16) | (_x << 16);
+    }
+
+    // Radical inverse of _i in the base PRIMES[_dim].
+    static ei::uint32 radicalInverse(const RadicalInverseTables& _tables, ei::uint32 _i, ei::uint32 _dim)
+    {
+        // Base 2: all weights are exact powers of two and the reverse
+        // permutation is the identity.
+        if(_dim == 0)
+            return reverseBits(_i);
+        const RadicalInverseBase& b = _tables.bases[_dim];
+        const ei::uint32* t = b.table.data();
+        ei::uint32 result = 0;
+        for(ei::uint32 p = 0; _i > 0 && p < b.numChunks; ++p, t += b.chunkBase)
+        {
+            ei::uint32 q = _i / b.chunkBase;
+            result += t[_i - q * b.chunkBase];
+            _i = q;
+        }
+        return result;
+    }
+
+    // Sequential evaluation of radical inverses for consecutive indices. The
+    // digits are incremented with carry and the value is updated by the
+    // difference of the changed digits only.
+    struct RadicalInverseCounter
+    {
+        const RadicalInverseBase* base;
+        ei::uint32 digits[32];
+        ei::uint32 value;
+
+        void reset(const RadicalInverseTables& _tables, ei::uint32 _index, ei::uint32 _dim)
+        {
+            base = &_tables.bases[_dim];
+            value = radicalInverse(_tables, _index, _dim);
+            for(int j = 0; j < 32; ++j, _index /= base->base)
+                digits[j] = _index % base->base;
+        }
+
+        void increment()
+        {
+            for(int j = 0; j < 32; ++j)
+            {
+                ei::uint32 old = digits[j];
+                ei::uint32 d = old + 1 == base->base ? 0 : old + 1;
+                digits[j] = d;
+                value += (base->digitValue(d) - base->digitValue(old)) * base->weight[j];
+                if(d != 0) break;
+            }
+        }
+    };
+
+    // Shared implementation of fill() for the Halton generators.
+    static void haltonFill(const RadicalInverseTables& _tables, ei::uint32 _numBases, ei::uint32& _counter, ei::uint32* _out, size_t _n)
+    {
+        ei::uint32 dim = _counter % _numBases;
+        ei::uint32 index = _counter / _numBases;
+        if(_n < 4 * _numBases)
+        {
+            // Setting up the counters does not pay off for short sequences
+            for(size_t k = 0; k < _n; ++k)
+            {
+                _out[k] = radicalInverse(_tables, index, dim);
+                if(++dim == _numBases) { dim = 0; ++index; }
+            }
+        } else {
+            // One digit counter per dimension, initialized to the index which
+            // is produced next in this dimension.
+            RadicalInverseCounter digits[32];
+            for(ei::uint32 d = 0; d < _numBases; ++d)
+                digits[d].reset(_tables, d < dim ? index + 1 : index, d);
+            for(size_t k = 0; k < _n; ++k)
+            {
+                _out[k] = digits[dim].value;
+                digits[dim].increment();
+                if(++dim == _numBases) dim = 0;
+            }
+        }
+        _counter += ei::uint32(_n);
+    }
+
+    // Shared implementation of generateBlock() for the Halton generators.
+    static void haltonBlock(const RadicalInverseTables& _tables, ei::uint32 _numBases, ei::uint32 _first, ei::uint32 _count, ei::uint32* _out)
+    {
+        for(ei::uint32 d = 0; d < _numBases; ++d, _out += _count)
+        {
+            RadicalInverseCounter digits;
+            digits.reset(_tables, _first, d);
+            for(ei::uint32 i = 0; i < _count; ++i)
+            {
+                _out[i] = digits.value;
+                digits.increment();
+            }
+        }
+    }
+
+    HaltonRng::HaltonRng(ei::uint32 _numBases) :
+        numBases(_numBases),
+        counter(_numBases) // Skip all the 0 entries
+    {
+    }
+
+    ei::uint32 HaltonRng::operator () ()
+    {
+        ei::uint32 dim = counter % numBases;
+        ei::uint32 i = counter / numBases;
+        ++counter;
+        return radicalInverse(haltonTables(), i, dim);
+    }
+
+    void HaltonRng::fill(ei::uint32* _out, size_t _n)
+    {
+        haltonFill(haltonTables(), numBases, counter, _out, _n);
+    }
+
+    void HaltonRng::fill(ei::uint64* _out, size_t _n)
+    {
+        fill64(*this, _out, _n);
+    }
+
+    ei::uint32 HaltonRng::at(ei::uint32 _index, ei::uint32 _dim) const
+    {
+        return radicalInverse(haltonTables(), _index, _dim);
+    }
+
+    void HaltonRng::point(ei::uint32 _index, ei::uint32* _out) const
+    {
+        const RadicalInverseTables& tables = haltonTables();
+        for(ei::uint32 d = 0; d < numBases; ++d)
+            _out[d] = radicalInverse(tables, _index, d);
+    }
+
+    void HaltonRng::generateBlock(ei::uint32 _first, ei::uint32 _count, ei::uint32* _out) const
+    {
+        haltonBlock(haltonTables(), numBases, _first, _count, _out);
+    }
+
+
+    HaltonRevRng::HaltonRevRng(ei::uint32 _numBases) :
+        numBases(_numBases),
+        counter(_numBases) // Skip all the 0 entries
+    {
+    }
+
+    ei::uint32 HaltonRevRng::operator () ()
+    {
+        ei::uint32 dim = counter % numBases;
+        ei::uint32 i = counter / numBases;
+        ++counter;
+        return radicalInverse(haltonRevTables(), i, dim);
+    }
+
+    void HaltonRevRng::fill(ei::uint32* _out, size_t _n)
+    {
+        haltonFill(haltonRevTables(), numBases, counter, _out, _n);
+    }
+
+    void HaltonRevRng::fill(ei::uint64* _out, size_t _n)
+    {
+        fill64(*this, _out, _n);
+    }
+
+    ei::uint32 HaltonRevRng::at(ei::uint32 _index, ei::uint32 _dim) const
+    {
+        return radicalInverse(haltonRevTables(), _index, _dim);
+    }
+
+    void HaltonRevRng::point(ei::uint32 _index, ei::uint32* _out) const
+    {
+        const RadicalInverseTables& tables = haltonRevTables();
+        for(ei::uint32 d = 0; d < numBases; ++d)
+            _out[d] = radicalInverse(tables, _index, d);
+    }
+
+    void HaltonRevRng::generateBlock(ei::uint32 _first, ei::uint32 _count, ei::uint32* _out) const
+    {
+        haltonBlock(haltonRevTables(), numBases, _first, _count, _out);
+    }
+
+
+    // Bases are computed as (2^32-1) * frac(sqrt(<Prime>))
+    const ei::uint32 AdditiveRecurrenceRng::BASES[8] = {
+                                2654435769, 1779033704, 3144134277, 1013904243,
+                                2773480762, 1359893119, 2600822924,  528734636};
+
+    AdditiveRecurrenceRng::AdditiveRecurrenceRng(ei::uint32 _numBases) :
+        numBases(_numBases),
+        counter(0)
+    {
+    }
+
+    ei::uint32 AdditiveRecurrenceRng::operator () ()
+    {
+        ei::uint32 base = BASES[counter % numBases];
+        ei::uint32 i = counter / numBases;
+        ++counter;
+        return base * i;
+    }
+
+    void AdditiveRecurrenceRng::fill(ei::uint32* _out, size_t _n)
+    {
+        // Track the dimension and the sample index incrementally instead of
+        // dividing the counter in each step.
+        ei::uint32 c = counter;
+        ei::uint32 d = c % numBases;
+        ei::uint32 i = c / numBases;
+        for(size_t k = 0; k < _n; ++k)
+        {
+            _out[k] = BASES[d] * i;
+            if(++d == numBases) { d = 0; ++i; }
+        }
+        counter = c + ei::uint32(_n);
+    }
+
+    void AdditiveRecurrenceRng::fill(ei::uint64* _out, size_t _n)
+    {
+        fill64(*this, _out, _n);
+    }
+
+    ei::uint32 AdditiveRecurrenceRng::at(ei::uint32 _index, ei::uint32 _dim) const
+    {
+        return BASES[_dim] * _index;
+    }
+
+    void AdditiveRecurrenceRng::point(ei::uint32 _index, ei::uint32* _out) const
+    {
+        for(ei::uint32 d = 0; d < numBases; ++d)
+            _out[d] = BASES[d] * _index;
+    }
+
+    void AdditiveRecurrenceRng::generateBlock(ei::uint32 _first, ei::uint32 _count, ei::uint32* _out) const
+    {
+        for(ei::uint32 d = 0; d < numBases; ++d, _out += _count)
+        {
+            ei::uint32 x = BASES[d] * _first;
+            for(ei::uint32 i = 0; i < _count; ++i, x += BASES[d])
+                _out[i] = x;
+        }
+    }
+
+
+    HammersleyRng::HammersleyRng(ei::uint32 _numBases, ei::uint32 _numSamples) :
+        numBases(_numBases),
+        numSamples(_numSamples),
+        counter(0)
+    {
+    }
+
+    ei::uint32 HammersleyRng::operator () ()
+    {
+        ei::uint32 dim = counter % numBases;
+        ei::uint32 i = counter++ / numBases;
+        return at(i, dim);
+    }
+
+    void HammersleyRng::fill(ei::uint32* _out, size_t _n)
+    {
+        ei::uint32 c = counter;
+        for(size_t k = 0; k < _n; ++k, ++c)
+            _out[k] = at(c / numBases, c % numBases);
+        counter = c;
+    }
+
+    void HammersleyRng::fill(ei::uint64* _out, size_t _n)
+    {
+        fill64(*this, _out, _n);
+    }
+
+    ei::uint32 HammersleyRng::at(ei::uint32 _index, ei::uint32 _dim) const
+    {
+        // First dimension is n/N
+        if(_dim == 0)
+            return ei::uint32((ei::uint64(_index) * (1ull<<32)) / numSamples);
+        // All others are Halton sequences
+        return radicalInverse(haltonTables(), _index, _dim - 1);
+    }
+
+    void HammersleyRng::point(ei::uint32 _index, ei::uint32* _out) const
+    {
+        for(ei::uint32 d = 0; d < numBases; ++d)
+            _out[d] = at(_index, d);
+    }
+
+    void HammersleyRng::generateBlock(ei::uint32 _first, ei::uint32 _count, ei::uint32* _out) const
+    {
+        for(ei::uint32 i = 0; i < _count; ++i)
+            _out[i] = at(_first + i, 0);
+        if(numBases > 1)
+            haltonBlock(haltonTables(), numBases - 1, _first, _count, _out + _count);
+    }
+
+
+    // Primitive polynomials and initial direction numbers for the dimensions
+    // 2 to 64 of the Sobol sequence following S. Joe and F. Y. Kuo
+    // "Constructing Sobol sequences with better two-dimensional projections".
+    // s: degree of the polynomial, a: inner coefficients, m: initial numbers
+    struct SobolPolynomial
+    {
+        ei::uint32 s;
+        ei::uint32 a;
+        ei::uint32 m[9];
+    };
+    static const SobolPolynomial SOBOL_POLYNOMIALS[63] = {
+        {1,   0, {1}},
+        {2,   1, {1, 3}},
+        {3,   1, {1, 3, 1}},
+        {3,   2, {1, 1, 1}},
+        {4,   1, {1, 1, 3, 3}},
+        {4,   4, {1, 3, 5, 13}},
+        {5,   2, {1, 1, 5, 5, 17}},
+        {5,   4, {1, 1, 5, 5, 5}},
+        {5,   7, {1, 1, 7, 11, 19}},
+        {5,  11, {1, 1, 5, 1, 1}},
+        {5,  13, {1, 1, 1, 3, 11}},
+        {5,  14, {1, 3, 5, 5, 31}},
+        {6,   1, {1, 3, 3, 9, 7, 49}},
+        {6,  13, {1, 1, 1, 15, 21, 21}},
+        {6,  16, {1, 3, 1, 13, 27, 49}},
+        {6,  19, {1, 1, 1, 15, 7, 5}},
+        {6,  22, {1, 3, 1, 15, 13, 25}},
+        {6,  25, {1, 1, 5, 5, 19, 61}},
+        {7,   1, {1, 3, 7, 11, 23, 15, 103}},
+        {7,   4, {1, 3, 7, 13, 13, 15, 69}},
+        {7,   7, {1, 1, 3, 13, 7, 35, 63}},
+        {7,   8, {1, 3, 5, 9, 1, 25, 53}},
+        {7,  14, {1, 3, 1, 13, 9, 35, 107}},
+        {7,  19, {1, 3, 1, 5, 27, 61, 31}},
+        {7,  21, {1, 1, 5, 11, 19, 41, 61}},
+        {7,  28, {1, 3, 5, 3, 3, 13, 69}},
+        {7,  31, {1, 1, 7, 13, 1, 19, 1}},
+        {7,  32, {1, 3, 7, 5, 13, 19, 59}},
+        {7,  37, {1, 1, 3, 9, 25, 29, 41}},
+        {7,  41, {1, 3, 5, 13, 23, 1, 55}},
+        {7,  42, {1, 3, 7, 3, 13, 59, 17}},
+        {7,  50, {1, 3, 1, 3, 5, 53, 69}},
+        {7,  55, {1, 1, 5, 5, 23, 33, 13}},
+        {7,  56, {1, 1, 7, 7, 1, 61, 123}},
+        {7,  59, {1, 1, 7, 9, 13, 61, 49}},
+        {7,  62, {1, 3, 3, 5, 3, 55, 33}},
+        {8,  14, {1, 3, 1, 15, 31, 13, 49, 245}},
+        {8,  21, {1, 3, 5, 15, 31, 59, 63, 97}},
+        {8,  22, {1, 3, 1, 11, 11, 11, 77, 249}},
+        {8,  38, {1, 3, 1, 11, 27, 43, 71, 9}},
+        {8,  47, {1, 1, 7, 15, 21, 11, 81, 45}},
+        {8,  49, {1, 3, 7, 3, 25, 31, 65, 79}},
+        {8,  50, {1, 3, 1, 1, 19, 11, 3, 205}},
+        {8,  52, {1, 1, 5, 9, 19, 21, 29, 157}},
+        {8,  56, {1, 3, 7, 11, 1, 33, 89, 185}},
+        {8,  67, {1, 3, 3, 3, 15, 9, 79, 71}},
+        {8,  70, {1, 3, 7, 11, 15, 39, 119, 27}},
+        {8,  84, {1, 1, 3, 1, 11, 31, 97, 225}},
+        {8,  97, {1, 1, 1, 3, 23, 43, 57, 177}},
+        {8, 103, {1, 3, 7, 7, 17, 17, 37, 71}},
+        {8, 115, {1, 3, 1, 5, 27, 63, 123, 213}},
+        {8, 122, {1, 1, 3, 5, 11, 43, 53, 133}},
+        {9,   8, {1, 3, 5, 5, 29, 17, 47, 173, 479}},
+        {9,  13, {1, 3, 3, 11, 3, 1, 109, 9, 69}},
+        {9,  16, {1, 1, 1, 5, 17, 39, 23, 5, 343}},
+        {9,  22, {1, 3, 1, 5, 25, 15, 31, 103, 499}},
+        {9,  25, {1, 1, 1, 11, 11, 17, 63, 105, 183}},
+        {9,  44, {1, 1, 5, 11, 9, 29, 97, 231, 363}},
+        {9,  47, {1, 1, 5, 15, 19, 45, 41, 7, 383}},
+        {9,  52, {1, 3, 7, 5, 23, 63, 11, 169, 61}},
+        {9,  55, {1, 1, 5, 13, 17, 15, 99, 121, 423}},
+        {9,  59, {1, 3, 5, 13, 27, 55, 59, 57, 201}},
+        {9,  62, {1, 3, 7, 11, 7, 21, 1, 199, 335}}
+    };
+
+    // Direction numbers v[d][j] for all dimensions and bits. The first
+    // dimension is the van der Corput sequence in base 2.
+    struct SobolDirections
+    {
+        ei::uint32 v[64][32];
+
+        SobolDirections()
+        {
+            for(int j = 0; j < 32; ++j)
+                v[0][j] = 1u << (31 - j);
+            for(int d = 1; d < 64; ++d)
+            {
+                const SobolPolynomial& p = SOBOL_POLYNOMIALS[d - 1];
+                ei::uint32 s = p.s;
+                for(ei::uint32 j = 0; j < s && j < 32; ++j)
+                    v[d][j] = p.m[j] << (31 - j);
+                for(ei::uint32 j = s; j < 32; ++j)
+                {
+                    ei::uint32 x = v[d][j - s] ^ (v[d][j - s] >> s);
+                    for(ei::uint32 k = 1; k < s; ++k)
+                        if((p.a >> (s - 1 - k)) & 1)
+                            x ^= v[d][j - k];
+                    v[d][j] = x;
+                }
+            }
+        }
+    };
+
+    static const SobolDirections& sobolDirections()
+    {
+        static const SobolDirections DIRECTIONS;
+        return DIRECTIONS;
+    }
+
+    // Index of the bit which changes in the Gray-code from _i-1 to _i.
+    // For _i = 0 (overflow) this is the highest bit.
+    static inline ei::uint32 grayCodeChange(ei::uint32 _i)
+    {
+        if(_i == 0) return 31;
+#ifdef _MSC_VER
+        unsigned long idx;
+        _BitScanForward(&idx, _i);
+        return idx;
+#else
+        return __builtin_ctz(_i);
+#endif
+    }
+
+    static ei::uint32 sobol(const ei::uint32* _v, ei::uint32 _index)
+    {
+        ei::uint32 gray = _index ^ (_index >> 1);
+        ei::uint32 result = 0;
+        for(; gray; gray >>= 1, ++_v)
+            if(gray & 1) result ^= *_v;
+        return result;
+    }
+
+    SobolRng::SobolRng(ei::uint32 _numDims) :
+        numDims(_numDims)
+    {
+        setState(_numDims); // Skip the 0 point
+    }
+
+    ei::uint32 SobolRng::operator () ()
+    {
+        ei::uint32 x = state[dim];
+        if(++dim == numDims)
+        {
+            // Move to the next point in Gray-code order
+            dim = 0;
+            ei::uint32 j = grayCodeChange(++index);
+            const SobolDirections& dir = sobolDirections();
+            for(ei::uint32 d = 0; d < numDims; ++d)
+                state[d] ^= dir.v[d][j];
+        }
+        return x;
+    }
+
+    void SobolRng::fill(ei::uint32* _out, size_t _n)
+    {
+        const SobolDirections& dir = sobolDirections();
+        for(size_t k = 0; k < _n; ++k)
+        {
+            _out[k] = state[dim];
+            if(++dim == numDims)
+            {
+                dim = 0;
+                ei::uint32 j = grayCodeChange(++index);
+                for(ei::uint32 d = 0; d < numDims; ++d)
+                    state[d] ^= dir.v[d][j];
+            }
+        }
+    }
+
+    void SobolRng::fill(ei::uint64* _out, size_t _n)
+    {
+        fill64(*this, _out, _n);
+    }
+
+    ei::uint32 SobolRng::at(ei::uint32 _index, ei::uint32 _dim) const
+    {
+        return sobol(sobolDirections().v[_dim], _index);
+    }
+
+    void SobolRng::point(ei::uint32 _index, ei::uint32* _out) const
+    {
+        const SobolDirections& dir = sobolDirections();
+        for(ei::uint32 d = 0; d < numDims; ++d)
+            _out[d] = sobol(dir.v[d], _index);
+    }
+
+    void SobolRng::generateBlock(ei::uint32 _first, ei::uint32 _count, ei::uint32* _out) const
+    {
+        const SobolDirections& dir = sobolDirections();
+        for(ei::uint32 d = 0; d < numDims; ++d, _out += _count)
+        {
+            ei::uint32 x = sobol(dir.v[d], _first);
+            for(ei::uint32 i = 0; i < _count; ++i)
+            {
+                _out[i] = x;
+                x ^= dir.v[d][grayCodeChange(_first + i + 1)];
+            }
+        }
+    }
+
+    void SobolRng::setState(ei::uint32 _state)
+    {
+        index = _state / numDims;
+        dim = _state % numDims;
+        point(index, state);
+    }
+
+
+    ei::uint32 KnuthHash::operator () (ei::uint32 _x) const
+    {
+        return _x * 2654435761;
+    }
+
+    ei::uint32 WangHash::operator () (ei::uint32 _x) const
+    {
+        _x = (_x ^ 61) ^ (_x >> 16);
+        _x *= 9;
+        _x = _x ^ (_x >> 4);
+        _x *= 0x27d4eb2d;
+        _x = _x ^ (_x >> 15);
+        return _x;
+		// 2007 variant: https://gist.github.com/badboy/6267743
+		/*_x = ~_x + (_x << 15); // _x = (_x << 15) - _x - 1;
+		_x = _x ^ (_x >> 12);
+		_x = _x + (_x << 2);
+		_x = _x ^ (_x >> 4);
+		_x = _x * 2057; // _x = (_x + (_x << 3)) + (_x << 11);
+		_x = _x ^ (_x >> 16);
+		return _x;*/
+    }
+
+    ei::uint32 JenkinsHash::operator () (ei::uint32 _x) const
+    {
+        _x = (_x + 0x7ed55d16) + (_x << 12);
+        _x = (_x ^ 0xc761c23c) ^ (_x >> 19);
+        _x = (_x + 0x165667b1) + (_x << 5);
+        _x = (_x + 0xd3a2646c) ^ (_x << 9);
+        _x = (_x + 0xfd7046c5) + (_x << 3);
+        _x = (_x ^ 0xb55a4f09) ^ (_x >> 16);
+        return _x;
+    }
+
+    ei::uint32 Murmur32Hash::operator () (ei::uint32 _x) const
+    {
+        _x ^= _x >> 16;
+        _x *= 0x85ebca6bu;
+        _x ^= _x >> 13;
+        _x *= 0xc2b2ae35u;
+        _x ^= _x >> 16;
+        return _x;
+    }
+
+    ei::uint32 ProspectorHash::operator () (ei::uint32 _x) const
+    {
+        _x ^= _x >> 16;
+        _x *= 0x7feb352du;
+        _x ^= _x >> 15;
+        _x *= 0x846ca68bu;
+        _x ^= _x >> 16;
+        return _x;
+    }
+
+    ei::uint32 ProspectorXHash::operator () (ei::uint32 _x) const
+    {
+        _x ^= _x >> 17;
+        _x *= 0xed5ad4bbu;
+        _x ^= _x >> 11;
+        _x *= 0xac4c1b51u;
+        _x ^= _x >> 15;
+        _x *= 0x31848babu;
+        _x ^= _x >> 14;
+        return _x;
+    }
+
+    ei::uint64 Splitmix64Hash::operator () (ei::uint64 _x) const
     {
         _x ^= _x >> 30;
         _x *= 0xbf58476d1ce4e5b9ull;
@@ -326,6 +1699,509 @@ namespace cn {
         return _x;
     }
 
+#if defined(__GNUC__) && !defined(__clang__)
+    // The kernels are inlined into the target specific entry functions, so
+    // the ABI notes do not apply. GCC's AVX-512 headers trigger false
+    // positives for uninitialized variables.
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Wpsabi"
+#   pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+    // Hash kernels for batch processing. Ops is a SIMD wrapper with W 32 bit
+    // lanes (W/2 64 bit lanes). Each kernel is exactly the scalar operator ().
+    // The vectors are passed by reference, because the kernels themselves are
+    // not compiled for a specific target (they are inlined into one).
+    struct KnuthKernel
+    {
+        template<typename Ops> static void apply(typename Ops::V& _x)
+        {
+            _x = Ops::mul32(_x, Ops::splat32(2654435761u));
+        }
+    };
+
+    struct WangKernel
+    {
+        template<typename Ops> static void apply(typename Ops::V& _x)
+        {
+            _x = Ops::bxor(Ops::bxor(_x, Ops::splat32(61)), Ops::template shr32<16>(_x));
+            _x = Ops::mul32(_x, Ops::splat32(9));
+            _x = Ops::bxor(_x, Ops::template shr32<4>(_x));
+            _x = Ops::mul32(_x, Ops::splat32(0x27d4eb2d));
+            _x = Ops::bxor(_x, Ops::template shr32<15>(_x));
+        }
+    };
+
+    struct JenkinsKernel
+    {
+        template<typename Ops> static void apply(typename Ops::V& _x)
+        {
+            _x = Ops::add32(Ops::add32(_x, Ops::splat32(0x7ed55d16)), Ops::template shl32<12>(_x));
+            _x = Ops::bxor(Ops::bxor(_x, Ops::splat32(0xc761c23c)), Ops::template shr32<19>(_x));
+            _x = Ops::add32(Ops::add32(_x, Ops::splat32(0x165667b1)), Ops::template shl32<5>(_x));
+            _x = Ops::bxor(Ops::add32(_x, Ops::splat32(0xd3a2646c)), Ops::template shl32<9>(_x));
+            _x = Ops::add32(Ops::add32(_x, Ops::splat32(0xfd7046c5)), Ops::template shl32<3>(_x));
+            _x = Ops::bxor(Ops::bxor(_x, Ops::splat32(0xb55a4f09)), Ops::template shr32<16>(_x));
+        }
+    };
+
+    // Xor-shift-multiply finalizers (Murmur3 and Prospector)
+    template<int S0, ei::uint32 M0, int S1, ei::uint32 M1, int S2>
+    struct XorShiftMulKernel
+    {
+        template<typename Ops> static void apply(typename Ops::V& _x)
+        {
+            _x = Ops::bxor(_x, Ops::template shr32<S0>(_x));
+            _x = Ops::mul32(_x, Ops::splat32(M0));
+            _x = Ops::bxor(_x, Ops::template shr32<S1>(_x));
+            _x = Ops::mul32(_x, Ops::splat32(M1));
+            _x = Ops::bxor(_x, Ops::template shr32<S2>(_x));
+        }
+    };
+    typedef XorShiftMulKernel<16, 0x85ebca6bu, 13, 0xc2b2ae35u, 16> Murmur32Kernel;
+    typedef XorShiftMulKernel<16, 0x7feb352du, 15, 0x846ca68bu, 16> ProspectorKernel;
+
+    struct ProspectorXKernel
+    {
+        template<typename Ops> static void apply(typename Ops::V& _x)
+        {
+            _x = Ops::bxor(_x, Ops::template shr32<17>(_x));
+            _x = Ops::mul32(_x, Ops::splat32(0xed5ad4bbu));
+            _x = Ops::bxor(_x, Ops::template shr32<11>(_x));
+            _x = Ops::mul32(_x, Ops::splat32(0xac4c1b51u));
+            _x = Ops::bxor(_x, Ops::template shr32<15>(_x));
+            _x = Ops::mul32(_x, Ops::splat32(0x31848babu));
+            _x = Ops::bxor(_x, Ops::template shr32<14>(_x));
+        }
+    };
+
+    struct Splitmix64Kernel
+    {
+        template<typename Ops> static void apply(typename Ops::V& _x)
+        {
+            _x = Ops::bxor(_x, Ops::template shr64<30>(_x));
+            _x = Ops::mul64(_x, Ops::splat64(0xbf58476d1ce4e5b9ull));
+            _x = Ops::bxor(_x, Ops::template shr64<27>(_x));
+            _x = Ops::mul64(_x, Ops::splat64(0x94d049bb133111ebull));
+            _x = Ops::bxor(_x, Ops::template shr64<31>(_x));
+        }
+    };
+
+    // Apply a kernel to all full vectors of the input. Returns the number of
+    // processed elements.
+    template<typename Ops, typename Kernel, typename T>
+    static size_t hashVectors(const T* _in, T* _out, size_t _n)
+    {
+        const size_t W = Ops::W * 4 / sizeof(T);
+        size_t i = 0;
+        for(; i + W <= _n; i += W)
+        {
+            typename Ops::V x = Ops::load(_in + i);
+            Kernel::template apply<Ops>(x);
+            Ops::store(_out + i, x);
+        }
+        return i;
+    }
+
+#ifdef CN_RUNTIME_DISPATCH
+    // 64 bit lane multiplication (low half) from 32x32->64 bit products:
+    // a*b = lo(a)*lo(b) + ((hi(a)*lo(b) + lo(a)*hi(b)) << 32)
+    struct Sse41Ops
+    {
+        typedef __m128i V;
+        enum { W = 4 };
+        CN_TARGET("sse4.1") static V load(const void* _p) { return _mm_loadu_si128(static_cast<const __m128i*>(_p)); }
+        CN_TARGET("sse4.1") static void store(void* _p, V _x) { _mm_storeu_si128(static_cast<__m128i*>(_p), _x); }
+        CN_TARGET("sse4.1") static V splat32(ei::uint32 _x) { return _mm_set1_epi32(int(_x)); }
+        CN_TARGET("sse4.1") static V splat64(ei::uint64 _x) { return _mm_set1_epi64x((long long)_x); }
+        CN_TARGET("sse4.1") static V bxor(V _a, V _b) { return _mm_xor_si128(_a, _b); }
+        CN_TARGET("sse4.1") static V add32(V _a, V _b) { return _mm_add_epi32(_a, _b); }
+        CN_TARGET("sse4.1") static V mul32(V _a, V _b) { return _mm_mullo_epi32(_a, _b); }
+        template<int K> CN_TARGET("sse4.1") static V shl32(V _x) { return _mm_slli_epi32(_x, K); }
+        template<int K> CN_TARGET("sse4.1") static V shr32(V _x) { return _mm_srli_epi32(_x, K); }
+        template<int K> CN_TARGET("sse4.1") static V shr64(V _x) { return _mm_srli_epi64(_x, K); }
+        CN_TARGET("sse4.1") static V mul64(V _a, V _b)
+        {
+            V cross = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(_a, 32), _b), _mm_mul_epu32(_a, _mm_srli_epi64(_b, 32)));
+            return _mm_add_epi64(_mm_mul_epu32(_a, _b), _mm_slli_epi64(cross, 32));
+        }
+    };
+
+    struct Avx2Ops
+    {
+        typedef __m256i V;
+        enum { W = 8 };
+        CN_TARGET("avx2") static V load(const void* _p) { return _mm256_loadu_si256(static_cast<const __m256i*>(_p)); }
+        CN_TARGET("avx2") static void store(void* _p, V _x) { _mm256_storeu_si256(static_cast<__m256i*>(_p), _x); }
+        CN_TARGET("avx2") static V splat32(ei::uint32 _x) { return _mm256_set1_epi32(int(_x)); }
+        CN_TARGET("avx2") static V splat64(ei::uint64 _x) { return _mm256_set1_epi64x((long long)_x); }
+        CN_TARGET("avx2") static V bxor(V _a, V _b) { return _mm256_xor_si256(_a, _b); }
+        CN_TARGET("avx2") static V add32(V _a, V _b) { return _mm256_add_epi32(_a, _b); }
+        CN_TARGET("avx2") static V mul32(V _a, V _b) { return _mm256_mullo_epi32(_a, _b); }
+        template<int K> CN_TARGET("avx2") static V shl32(V _x) { return _mm256_slli_epi32(_x, K); }
+        template<int K> CN_TARGET("avx2") static V shr32(V _x) { return _mm256_srli_epi32(_x, K); }
+        template<int K> CN_TARGET("avx2") static V shr64(V _x) { return _mm256_srli_epi64(_x, K); }
+        CN_TARGET("avx2") static V mul64(V _a, V _b)
+        {
+            V cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(_a, 32), _b), _mm256_mul_epu32(_a, _mm256_srli_epi64(_b, 32)));
+            return _mm256_add_epi64(_mm256_mul_epu32(_a, _b), _mm256_slli_epi64(cross, 32));
+        }
+    };
+
+    struct Avx512Ops
+    {
+        typedef __m512i V;
+        enum { W = 16 };
+        CN_TARGET("avx512f") static V load(const void* _p) { return _mm512_loadu_si512(_p); }
+        CN_TARGET("avx512f") static void store(void* _p, V _x) { _mm512_storeu_si512(_p, _x); }
+        CN_TARGET("avx512f") static V splat32(ei::uint32 _x) { return _mm512_set1_epi32(int(_x)); }
+        CN_TARGET("avx512f") static V splat64(ei::uint64 _x) { return _mm512_set1_epi64((long long)_x); }
+        CN_TARGET("avx512f") static V bxor(V _a, V _b) { return _mm512_xor_si512(_a, _b); }
+        CN_TARGET("avx512f") static V add32(V _a, V _b) { return _mm512_add_epi32(_a, _b); }
+        CN_TARGET("avx512f") static V mul32(V _a, V _b) { return _mm512_mullo_epi32(_a, _b); }
+        template<int K> CN_TARGET("avx512f") static V shl32(V _x) { return _mm512_slli_epi32(_x, K); }
+        template<int K> CN_TARGET("avx512f") static V shr32(V _x) { return _mm512_srli_epi32(_x, K); }
+        template<int K> CN_TARGET("avx512f") static V shr64(V _x) { return _mm512_srli_epi64(_x, K); }
+        CN_TARGET("avx512f") static V mul64(V _a, V _b)
+        {
+            V cross = _mm512_add_epi64(_mm512_mul_epu32(_mm512_srli_epi64(_a, 32), _b), _mm512_mul_epu32(_a, _mm512_srli_epi64(_b, 32)));
+            return _mm512_add_epi64(_mm512_mul_epu32(_a, _b), _mm512_slli_epi64(cross, 32));
+        }
+    };
+
+    template<typename Kernel, typename T>
+    CN_TARGET_ENTRY("sse4.1") static size_t hashSse41(const T* _in, T* _out, size_t _n)
+    {
+        return hashVectors<Sse41Ops, Kernel>(_in, _out, _n);
+    }
+
+    template<typename Kernel, typename T>
+    CN_TARGET_ENTRY("avx2") static size_t hashAvx2(const T* _in, T* _out, size_t _n)
+    {
+        return hashVectors<Avx2Ops, Kernel>(_in, _out, _n);
+    }
+
+    template<typename Kernel, typename T>
+    CN_TARGET_ENTRY("avx512f") static size_t hashAvx512(const T* _in, T* _out, size_t _n)
+    {
+        return hashVectors<Avx512Ops, Kernel>(_in, _out, _n);
+    }
+
+#endif // CN_RUNTIME_DISPATCH
+
+    // Hash an array with the best available kernel and the scalar hash for
+    // the remaining elements.
+    template<typename Kernel, typename Hash, typename T>
+    static void hashBatch(const Hash& _hash, const T* _in, T* _out, size_t _n)
+    {
+        size_t i = 0;
+#ifdef CN_RUNTIME_DISPATCH
+        switch(simdLevel())
+        {
+        case SimdLevel::AVX512: i = hashAvx512<Kernel>(_in, _out, _n); break;
+        case SimdLevel::AVX2: i = hashAvx2<Kernel>(_in, _out, _n); break;
+        case SimdLevel::SSE41: i = hashSse41<Kernel>(_in, _out, _n); break;
+        default: break;
+        }
+#endif
+        for(; i < _n; ++i)
+            _out[i] = _hash(_in[i]);
+    }
+
+    void KnuthHash::hash(const ei::uint32* _in, ei::uint32* _out, size_t _n) const
+    {
+        hashBatch<KnuthKernel>(*this, _in, _out, _n);
+    }
+
+    void WangHash::hash(const ei::uint32* _in, ei::uint32* _out, size_t _n) const
+    {
+        hashBatch<WangKernel>(*this, _in, _out, _n);
+    }
+
+    void JenkinsHash::hash(const ei::uint32* _in, ei::uint32* _out, size_t _n) const
+    {
+        hashBatch<JenkinsKernel>(*this, _in, _out, _n);
+    }
+
+    void Murmur32Hash::hash(const ei::uint32* _in, ei::uint32* _out, size_t _n) const
+    {
+        hashBatch<Murmur32Kernel>(*this, _in, _out, _n);
+    }
+
+    void ProspectorHash::hash(const ei::uint32* _in, ei::uint32* _out, size_t _n) const
+    {
+        hashBatch<ProspectorKernel>(*this, _in, _out, _n);
+    }
+
+    void ProspectorXHash::hash(const ei::uint32* _in, ei::uint32* _out, size_t _n) const
+    {
+        hashBatch<ProspectorXKernel>(*this, _in, _out, _n);
+    }
+
+    void Splitmix64Hash::hash(const ei::uint64* _in, ei::uint64* _out, size_t _n) const
+    {
+        hashBatch<Splitmix64Kernel>(*this, _in, _out, _n);
+    }
+
+    // Block step of MurmurHash3 for one 32 bit word.
+    static inline ei::uint32 murmurBlock(ei::uint32 _h, ei::uint32 _k)
+    {
+        _k *= 0xcc9e2d51u;
+        _k = (_k << 15) | (_k >> 17);
+        _k *= 0x1b873593u;
+        _h ^= _k;
+        _h = (_h << 13) | (_h >> 19);
+        return _h * 5 + 0xe6546b64u;
+    }
+
+    static inline ei::uint32 loadLE32(const ei::uint8* _p)
+    {
+        return ei::uint32(_p[0]) | (ei::uint32(_p[1]) << 8) | (ei::uint32(_p[2]) << 16) | (ei::uint32(_p[3]) << 24);
+    }
+
+    static void streamStripes(ei::uint32* _lane, const ei::uint8* _data, size_t _numStripes)
+    {
+        ei::uint32 h0 = _lane[0], h1 = _lane[1], h2 = _lane[2], h3 = _lane[3];
+        for(size_t i = 0; i < _numStripes; ++i, _data += 16)
+        {
+            h0 = murmurBlock(h0, loadLE32(_data));
+            h1 = murmurBlock(h1, loadLE32(_data + 4));
+            h2 = murmurBlock(h2, loadLE32(_data + 8));
+            h3 = murmurBlock(h3, loadLE32(_data + 12));
+        }
+        _lane[0] = h0; _lane[1] = h1; _lane[2] = h2; _lane[3] = h3;
+    }
+
+#ifdef CN_RUNTIME_DISPATCH
+    // The same block step for all four lanes in one register (x86 is little
+    // endian, so a plain load gives the words of a stripe).
+    CN_TARGET_ENTRY("sse4.1") static void streamStripesSse41(ei::uint32* _lane, const ei::uint8* _data, size_t _numStripes)
+    {
+        typedef Sse41Ops Ops;
+        const Ops::V c1 = Ops::splat32(0xcc9e2d51u);
+        const Ops::V c2 = Ops::splat32(0x1b873593u);
+        const Ops::V five = Ops::splat32(5);
+        const Ops::V add = Ops::splat32(0xe6546b64u);
+        Ops::V h = Ops::load(_lane);
+        for(size_t i = 0; i < _numStripes; ++i, _data += 16)
+        {
+            Ops::V k = Ops::mul32(Ops::load(_data), c1);
+            k = Ops::bxor(Ops::shl32<15>(k), Ops::shr32<17>(k));
+            k = Ops::mul32(k, c2);
+            h = Ops::bxor(h, k);
+            h = Ops::bxor(Ops::shl32<13>(h), Ops::shr32<19>(h));
+            h = Ops::add32(Ops::mul32(h, five), add);
+        }
+        Ops::store(_lane, h);
+    }
+#endif
+
+    StreamHash::StreamHash(ei::uint32 _seed) :
+        numPending(0),
+        length(0)
+    {
+        lane[0] = _seed + 0x9e3779b1u;
+        lane[1] = _seed + 0x85ebca77u;
+        lane[2] = _seed;
+        lane[3] = _seed - 0x9e3779b1u;
+    }
+
+    StreamHash& StreamHash::update(const void* _data, size_t _size)
+    {
+        const ei::uint8* data = static_cast<const ei::uint8*>(_data);
+        length += _size;
+        // Complete the pending stripe first
+        if(numPending > 0)
+        {
+            while(numPending < 16 && _size > 0)
+            {
+                pending[numPending++] = *data++;
+                --_size;
+            }
+            if(numPending < 16) return *this;
+            streamStripes(lane, pending, 1);
+            numPending = 0;
+        }
+        size_t numStripes = _size / 16;
+#ifdef CN_RUNTIME_DISPATCH
+        if(numStripes >= 4 && simdLevel() >= SimdLevel::SSE41)
+            streamStripesSse41(lane, data, numStripes);
+        else
+#endif
+            streamStripes(lane, data, numStripes);
+        data += numStripes * 16;
+        _size -= numStripes * 16;
+        for(size_t i = 0; i < _size; ++i)
+            pending[i] = data[i];
+        numPending = ei::uint32(_size);
+        return *this;
+    }
+
+    // Lanes after the zero padded last stripe. The padding is disambiguated
+    // by the length in the finalization.
+    static void finalLanes(const ei::uint32* _lane, const ei::uint8* _pending, ei::uint32 _numPending, ei::uint32* _out)
+    {
+        for(int i = 0; i < 4; ++i) _out[i] = _lane[i];
+        if(_numPending > 0)
+        {
+            ei::uint8 stripe[16] = {0};
+            for(ei::uint32 i = 0; i < _numPending; ++i) stripe[i] = _pending[i];
+            streamStripes(_out, stripe, 1);
+        }
+    }
+
+    ei::uint32 StreamHash::finish() const
+    {
+        ei::uint32 h[4];
+        finalLanes(lane, pending, numPending, h);
+        ei::uint32 x = ((h[0] << 1) | (h[0] >> 31)) + ((h[1] << 7) | (h[1] >> 25))
+                     + ((h[2] << 12) | (h[2] >> 20)) + ((h[3] << 18) | (h[3] >> 14));
+        x ^= ei::uint32(length) ^ ei::uint32(length >> 32);
+        return Murmur32Hash()(x);
+    }
+
+    ei::uint64 StreamHash::finish64() const
+    {
+        ei::uint32 h[4];
+        finalLanes(lane, pending, numPending, h);
+        ei::uint64 a = (ei::uint64(h[0]) << 32) | h[1];
+        ei::uint64 b = (ei::uint64(h[2]) << 32) | h[3];
+        Splitmix64Hash mix;
+        return mix(a ^ mix(b ^ length));
+    }
+
+    ei::uint64 seedFrom(const void* _data, size_t _size, ei::uint32 _salt)
+    {
+        return StreamHash(_salt).update(_data, _size).finish64();
+    }
+
+    ei::uint64 seedFromString(const char* _key, ei::uint32 _salt)
+    {
+        size_t size = 0;
+        while(_key[size]) ++size;
+        return seedFrom(_key, size, _salt);
+    }
+
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC diagnostic pop
+#endif
+
+    static inline void mulHiLo(ei::uint32 _a, ei::uint32 _b, ei::uint32& _hi, ei::uint32& _lo)
+    {
+        ei::uint64 p = ei::uint64(_a) * _b;
+        _hi = ei::uint32(p >> 32);
+        _lo = ei::uint32(p);
+    }
+
+    Philox4x32Hash::Philox4x32Hash(ei::uint64 _key)
+    {
+        key[0] = ei::uint32(_key);
+        key[1] = ei::uint32(_key >> 32);
+    }
+
+    ei::Vec<ei::uint32, 4> Philox4x32Hash::operator () (const ei::Vec<ei::uint32, 4>& _counter) const
+    {
+        ei::uint32 c0 = _counter[0], c1 = _counter[1], c2 = _counter[2], c3 = _counter[3];
+        ei::uint32 k0 = key[0], k1 = key[1];
+        for(int r = 0; r < 10; ++r)
+        {
+            ei::uint32 hi0, lo0, hi1, lo1;
+            mulHiLo(0xD2511F53, c0, hi0, lo0);
+            mulHiLo(0xCD9E8D57, c2, hi1, lo1);
+            c0 = hi1 ^ c1 ^ k0;
+            c1 = lo1;
+            c2 = hi0 ^ c3 ^ k1;
+            c3 = lo0;
+            // Weyl sequence for the round keys
+            k0 += 0x9E3779B9;
+            k1 += 0xBB67AE85;
+        }
+        return ei::Vec<ei::uint32, 4>(c0, c1, c2, c3);
+    }
+
+    Threefry2x64Hash::Threefry2x64Hash(ei::uint64 _key0, ei::uint64 _key1)
+    {
+        key[0] = _key0;
+        key[1] = _key1;
+        key[2] = 0x1BD11BDAA9FC1A22ull ^ _key0 ^ _key1;
+    }
+
+    ei::Vec<ei::uint64, 2> Threefry2x64Hash::operator () (const ei::Vec<ei::uint64, 2>& _counter) const
+    {
+        static const int ROTATIONS[8] = {16, 42, 12, 31, 16, 32, 24, 21};
+        ei::uint64 x0 = _counter[0] + key[0];
+        ei::uint64 x1 = _counter[1] + key[1];
+        for(int r = 0; r < 20; ++r)
+        {
+            x0 += x1;
+            x1 = (x1 << ROTATIONS[r % 8]) | (x1 >> (64 - ROTATIONS[r % 8]));
+            x1 ^= x0;
+            // Key injection after every 4 rounds
+            if((r & 3) == 3)
+            {
+                int s = (r + 1) / 4;
+                x0 += key[s % 3];
+                x1 += key[(s + 1) % 3] + s;
+            }
+        }
+        return ei::Vec<ei::uint64, 2>(x0, x1);
+    }
+
+    PhiloxRng::PhiloxRng(ei::uint64 _seed) :
+        hash(_seed),
+        counter(0)
+    {
+    }
+
+    // The counter of the hash is the 64 bit block index in the lower two words.
+    static inline ei::Vec<ei::uint32, 4> philoxBlock(const Philox4x32Hash& _hash, ei::uint64 _block)
+    {
+        return _hash(ei::Vec<ei::uint32, 4>(ei::uint32(_block), ei::uint32(_block >> 32), 0u, 0u));
+    }
+
+    ei::uint32 PhiloxRng::operator () ()
+    {
+        if((counter & 3) == 0)
+            buffer = philoxBlock(hash, counter >> 2);
+        return buffer[counter++ & 3];
+    }
+
+    void PhiloxRng::fill(ei::uint32* _out, size_t _n)
+    {
+        size_t k = 0;
+        // Finish the current block
+        while(k < _n && (counter & 3) != 0)
+            _out[k++] = buffer[counter++ & 3];
+        // Whole blocks
+        for(; k + 4 <= _n; k += 4, counter += 4)
+        {
+            ei::Vec<ei::uint32, 4> x = philoxBlock(hash, counter >> 2);
+            _out[k] = x[0]; _out[k+1] = x[1]; _out[k+2] = x[2]; _out[k+3] = x[3];
+        }
+        // Remainder
+        for(; k < _n; ++k)
+            _out[k] = (*this)();
+    }
+
+    void PhiloxRng::fill(ei::uint64* _out, size_t _n)
+    {
+        fill64(*this, _out, _n);
+    }
+
+    void PhiloxRng::discard(ei::uint64 _n)
+    {
+        counter += _n;
+        if((counter & 3) != 0)
+            buffer = philoxBlock(hash, counter >> 2);
+    }
+
+    ei::uint32 sample(ei::uint64 _seed, ei::uint64 _index, ei::uint32 _dimension)
+    {
+        ei::Vec<ei::uint32, 4> x = Philox4x32Hash(_seed)(ei::Vec<ei::uint32, 4>(
+            ei::uint32(_index), ei::uint32(_index >> 32), _dimension >> 2, 0u));
+        return x[_dimension & 3];
+    }
+
     ei::uint32 generateSeed()
     {
         // time gives some number, probably in seconds. Clock is added to give some
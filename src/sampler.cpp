@@ -0,0 +1,1092 @@
+#if defined(__GNUC__) && !defined(__clang__)
+// The kernels (including fastLog() and fastSinCos2pi() from sampler.inl) are
+// inlined into the target specific entry functions, so the ABI notes do not
+// apply. The templates are instantiated at the end of the file, hence the
+// setting is placed before all includes and holds for the whole file.
+#   pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+#include "cn/sampler.hpp"
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include "simd.hpp"
+
+namespace cn {
+
+    // SIMD wrappers for the sample conversion kernels. F is a vector of W
+    // floats and I a vector of W 32 bit integers. The scalar version
+    // (details::ScalarFloatOps in sampler.inl) has a single lane and computes
+    // the remaining elements (or everything if no SIMD instruction set is
+    // available). All wrappers use the same operations in the same order, so
+    // the results are bit identical (as long as the compiler does not
+    // contract the scalar code to FMAs).
+#ifdef CN_RUNTIME_DISPATCH
+    struct Sse2FloatOps
+    {
+        typedef __m128 F;
+        typedef __m128i I;
+        enum { W = 4 };
+        CN_TARGET("sse2") static I load(const ei::uint32* _p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(_p)); }
+        CN_TARGET("sse2") static F loadF(const float* _p) { return _mm_loadu_ps(_p); }
+        CN_TARGET("sse2") static void store(float* _p, F _x) { _mm_storeu_ps(_p, _x); }
+        CN_TARGET("sse2") static F splat(float _x) { return _mm_set1_ps(_x); }
+        CN_TARGET("sse2") static I splatI(ei::uint32 _x) { return _mm_set1_epi32(int(_x)); }
+        CN_TARGET("sse2") static F add(F _a, F _b) { return _mm_add_ps(_a, _b); }
+        CN_TARGET("sse2") static F sub(F _a, F _b) { return _mm_sub_ps(_a, _b); }
+        CN_TARGET("sse2") static F mul(F _a, F _b) { return _mm_mul_ps(_a, _b); }
+        CN_TARGET("sse2") static F div(F _a, F _b) { return _mm_div_ps(_a, _b); }
+        CN_TARGET("sse2") static F max(F _a, F _b) { return _mm_max_ps(_a, _b); }
+        CN_TARGET("sse2") static F sqrt(F _x) { return _mm_sqrt_ps(_x); }
+        CN_TARGET("sse2") static I addI(I _a, I _b) { return _mm_add_epi32(_a, _b); }
+        CN_TARGET("sse2") static I andI(I _a, I _b) { return _mm_and_si128(_a, _b); }
+        CN_TARGET("sse2") static I orI(I _a, I _b) { return _mm_or_si128(_a, _b); }
+        CN_TARGET("sse2") static I xorI(I _a, I _b) { return _mm_xor_si128(_a, _b); }
+        template<int K> CN_TARGET("sse2") static I shl(I _x) { return _mm_slli_epi32(_x, K); }
+        template<int K> CN_TARGET("sse2") static I shr(I _x) { return _mm_srli_epi32(_x, K); }
+        template<int K> CN_TARGET("sse2") static I sra(I _x) { return _mm_srai_epi32(_x, K); }
+        CN_TARGET("sse2") static F asF(I _x) { return _mm_castsi128_ps(_x); }
+        CN_TARGET("sse2") static I asI(F _x) { return _mm_castps_si128(_x); }
+        CN_TARGET("sse2") static F cvt(I _x) { return _mm_cvtepi32_ps(_x); }
+        CN_TARGET("sse2") static I trunc(F _x) { return _mm_cvttps_epi32(_x); }
+        CN_TARGET("sse2") static I greater(F _a, F _b) { return _mm_castps_si128(_mm_cmpgt_ps(_a, _b)); }
+        CN_TARGET("sse2") static F select(I _mask, F _a, F _b) { F m = _mm_castsi128_ps(_mask); return _mm_or_ps(_mm_and_ps(m, _a), _mm_andnot_ps(m, _b)); }
+    };
+
+    struct Avx2FloatOps
+    {
+        typedef __m256 F;
+        typedef __m256i I;
+        enum { W = 8 };
+        CN_TARGET("avx2") static I load(const ei::uint32* _p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_p)); }
+        CN_TARGET("avx2") static F loadF(const float* _p) { return _mm256_loadu_ps(_p); }
+        CN_TARGET("avx2") static void store(float* _p, F _x) { _mm256_storeu_ps(_p, _x); }
+        CN_TARGET("avx2") static F splat(float _x) { return _mm256_set1_ps(_x); }
+        CN_TARGET("avx2") static I splatI(ei::uint32 _x) { return _mm256_set1_epi32(int(_x)); }
+        CN_TARGET("avx2") static F add(F _a, F _b) { return _mm256_add_ps(_a, _b); }
+        CN_TARGET("avx2") static F sub(F _a, F _b) { return _mm256_sub_ps(_a, _b); }
+        CN_TARGET("avx2") static F mul(F _a, F _b) { return _mm256_mul_ps(_a, _b); }
+        CN_TARGET("avx2") static F div(F _a, F _b) { return _mm256_div_ps(_a, _b); }
+        CN_TARGET("avx2") static F max(F _a, F _b) { return _mm256_max_ps(_a, _b); }
+        CN_TARGET("avx2") static F sqrt(F _x) { return _mm256_sqrt_ps(_x); }
+        CN_TARGET("avx2") static I addI(I _a, I _b) { return _mm256_add_epi32(_a, _b); }
+        CN_TARGET("avx2") static I andI(I _a, I _b) { return _mm256_and_si256(_a, _b); }
+        CN_TARGET("avx2") static I orI(I _a, I _b) { return _mm256_or_si256(_a, _b); }
+        CN_TARGET("avx2") static I xorI(I _a, I _b) { return _mm256_xor_si256(_a, _b); }
+        template<int K> CN_TARGET("avx2") static I shl(I _x) { return _mm256_slli_epi32(_x, K); }
+        template<int K> CN_TARGET("avx2") static I shr(I _x) { return _mm256_srli_epi32(_x, K); }
+        template<int K> CN_TARGET("avx2") static I sra(I _x) { return _mm256_srai_epi32(_x, K); }
+        CN_TARGET("avx2") static F asF(I _x) { return _mm256_castsi256_ps(_x); }
+        CN_TARGET("avx2") static I asI(F _x) { return _mm256_castps_si256(_x); }
+        CN_TARGET("avx2") static F cvt(I _x) { return _mm256_cvtepi32_ps(_x); }
+        CN_TARGET("avx2") static I trunc(F _x) { return _mm256_cvttps_epi32(_x); }
+        CN_TARGET("avx2") static I greater(F _a, F _b) { return _mm256_castps_si256(_mm256_cmp_ps(_a, _b, _CMP_GT_OQ)); }
+        CN_TARGET("avx2") static F select(I _mask, F _a, F _b) { return _mm256_blendv_ps(_b, _a, _mm256_castsi256_ps(_mask)); }
+    };
+#endif // CN_RUNTIME_DISPATCH
+
+    // Uniform in [0,1[ from the upper 23 bits: the bits become the mantissa
+    // of a float in [1,2[.
+    template<typename Ops>
+    static typename Ops::F uniform01(const typename Ops::I& _x)
+    {
+        return Ops::sub(Ops::asF(Ops::orI(Ops::template shr<9>(_x), Ops::splatI(0x3f800000u))), Ops::splat(1.0f));
+    }
+
+    // Uniform in ]0,1] with all 32 bits as input for logarithms. The smallest
+    // value is 2^-32 (like in the double precision single sample functions).
+    template<typename Ops>
+    static typename Ops::F uniformLog(const typename Ops::I& _x)
+    {
+        typename Ops::F x = Ops::cvt(Ops::template shr<1>(_x));
+        return Ops::mul(Ops::add(x, Ops::splat(0.5f)), Ops::splat(4.656612873e-10f)); // 2^-31
+    }
+
+    // Conversion kernels. run() processes all full vectors and returns the
+    // number of consumed random numbers.
+    struct UniformKernel
+    {
+        float scale, offset;
+
+        template<typename Ops>
+        size_t run(const ei::uint32* _rnd, float* _out, size_t _n) const
+        {
+            size_t i = 0;
+            for(; i + Ops::W <= _n; i += Ops::W)
+            {
+                typename Ops::F u = uniform01<Ops>(Ops::load(_rnd + i));
+                Ops::store(_out + i, Ops::add(Ops::mul(u, Ops::splat(scale)), Ops::splat(offset)));
+            }
+            return i;
+        }
+    };
+
+    struct ExponentialKernel
+    {
+        float scale; // -1/lambda
+
+        template<typename Ops>
+        size_t run(const ei::uint32* _rnd, float* _out, size_t _n) const
+        {
+            size_t i = 0;
+            for(; i + Ops::W <= _n; i += Ops::W)
+            {
+                typename Ops::F v = uniformLog<Ops>(Ops::load(_rnd + i));
+                Ops::store(_out + i, Ops::mul(details::fastLog<Ops>(v), Ops::splat(scale)));
+            }
+            return i;
+        }
+    };
+
+    // Box-Muller transform on groups of 16 numbers: the first 8 give the
+    // radii, the second 8 the angles. The cosine samples are written to the
+    // first half, the sine samples to the second half of the group. The fixed
+    // group size makes the order independent of the vector width.
+    struct GaussianKernel
+    {
+        float sigma, mu;
+        enum { GROUP = 16 };
+
+        template<typename Ops>
+        size_t run(const ei::uint32* _rnd, float* _out, size_t _n) const
+        {
+            typedef typename Ops::F F;
+            size_t i = 0;
+            for(; i + GROUP <= _n; i += GROUP)
+                for(size_t k = i; k < i + GROUP / 2; k += Ops::W)
+                {
+                    F v = uniformLog<Ops>(Ops::load(_rnd + k));
+                    F u = uniform01<Ops>(Ops::load(_rnd + k + GROUP / 2));
+                    F r = Ops::mul(Ops::sqrt(Ops::mul(details::fastLog<Ops>(v), Ops::splat(-2.0f))), Ops::splat(sigma));
+                    F s, c;
+                    details::fastSinCos2pi<Ops>(u, s, c);
+                    Ops::store(_out + k, Ops::add(Ops::mul(r, c), Ops::splat(mu)));
+                    Ops::store(_out + k + GROUP / 2, Ops::add(Ops::mul(r, s), Ops::splat(mu)));
+                }
+            return i;
+        }
+
+        // The remaining numbers (less than a group) in pairs: the first
+        // number for the radius and the second for the angle.
+        void runPairs(const ei::uint32* _rnd, float* _out, size_t _n) const
+        {
+            typedef details::ScalarFloatOps Ops;
+            for(size_t i = 0; i < _n; i += 2)
+            {
+                float r = Ops::mul(Ops::sqrt(Ops::mul(details::fastLog<Ops>(uniformLog<Ops>(_rnd[i])), -2.0f)), sigma);
+                float s, c;
+                details::fastSinCos2pi<Ops>(uniform01<Ops>(_rnd[i+1]), s, c);
+                _out[i] = Ops::add(Ops::mul(r, c), mu);
+                _out[i+1] = Ops::add(Ops::mul(r, s), mu);
+            }
+        }
+    };
+
+#ifdef CN_RUNTIME_DISPATCH
+    template<typename Kernel>
+    CN_TARGET_ENTRY("sse2") static size_t convertSse2(const Kernel& _kernel, const ei::uint32* _rnd, float* _out, size_t _n)
+    {
+        return _kernel.template run<Sse2FloatOps>(_rnd, _out, _n);
+    }
+
+    template<typename Kernel>
+    CN_TARGET_ENTRY("avx2") static size_t convertAvx2(const Kernel& _kernel, const ei::uint32* _rnd, float* _out, size_t _n)
+    {
+        return _kernel.template run<Avx2FloatOps>(_rnd, _out, _n);
+    }
+#endif
+
+    // Convert with the widest available kernel and the scalar one for the rest.
+    template<typename Kernel>
+    static void convert(const Kernel& _kernel, const ei::uint32* _rnd, float* _out, size_t _n)
+    {
+        size_t i = 0;
+#ifdef CN_RUNTIME_DISPATCH
+        if(simdLevel() >= SimdLevel::AVX2)
+            i = convertAvx2(_kernel, _rnd, _out, _n);
+        else if(simdLevel() >= SimdLevel::SSE2)
+            i = convertSse2(_kernel, _rnd, _out, _n);
+#endif
+        _kernel.template run<details::ScalarFloatOps>(_rnd + i, _out + i, _n - i);
+    }
+
+    // Exact float(_x) for unsigned numbers like in the single sample
+    // functions (the SIMD conversion is signed only). Both halves convert
+    // exactly and the sum is rounded once.
+    template<typename Ops>
+    static typename Ops::F cvtUnsigned(const typename Ops::I& _x)
+    {
+        return Ops::add(Ops::mul(Ops::cvt(Ops::template shr<16>(_x)), Ops::splat(65536.0f)),
+                        Ops::cvt(Ops::andI(_x, Ops::splatI(0xffffu))));
+    }
+
+    // Same values as uniform(uint32) in [0,1] and uniformEx(uint32) in [0,1[.
+    template<typename Ops>
+    static typename Ops::F uniformInclusive(const typename Ops::I& _x)
+    {
+        return Ops::div(cvtUnsigned<Ops>(_x), Ops::splat(4294967295.0f));
+    }
+
+    template<typename Ops>
+    static typename Ops::F uniformExclusive(const typename Ops::I& _x)
+    {
+        return Ops::div(cvtUnsigned<Ops>(_x), Ops::splat(4294967810.0f));
+    }
+
+    template<typename Ops>
+    static typename Ops::F negate(const typename Ops::F& _x)
+    {
+        return Ops::asF(Ops::xorI(Ops::asI(_x), Ops::splatI(0x80000000u)));
+    }
+
+    // Random numbers and structure-of-arrays outputs of the batch direction
+    // samplers.
+    struct DirectionStreams
+    {
+        const ei::uint32* rnd0;
+        const ei::uint32* rnd1;
+        float* x;
+        float* y;
+        float* z;
+        float* pdf; // Optional
+    };
+
+    // Direction kernels with the formulas of the single sample functions in
+    // sampler.inl. Only sine, cosine and logarithm are approximated. run()
+    // processes all full vectors in [_begin, _n[ and returns the end of the
+    // processed range.
+    struct DirUniformKernel
+    {
+        template<typename Ops>
+        size_t run(const DirectionStreams& _io, size_t _begin, size_t _n) const
+        {
+            typedef typename Ops::F F;
+            const F one = Ops::splat(1.0f);
+            size_t i = _begin;
+            for(; i + Ops::W <= _n; i += Ops::W)
+            {
+                F cosTheta = Ops::sub(Ops::mul(uniformInclusive<Ops>(Ops::load(_io.rnd0 + i)), Ops::splat(2.0f)), one);
+                F sinTheta = Ops::sqrt(Ops::mul(Ops::sub(one, cosTheta), Ops::add(one, cosTheta)));
+                F s, c;
+                details::fastSinCos2pi<Ops>(uniformExclusive<Ops>(Ops::load(_io.rnd1 + i)), s, c);
+                Ops::store(_io.x + i, Ops::mul(sinTheta, s));
+                Ops::store(_io.y + i, Ops::mul(sinTheta, c));
+                Ops::store(_io.z + i, cosTheta);
+            }
+            return i;
+        }
+    };
+
+    struct DirCosineKernel
+    {
+        template<typename Ops>
+        size_t run(const DirectionStreams& _io, size_t _begin, size_t _n) const
+        {
+            typedef typename Ops::F F;
+            size_t i = _begin;
+            for(; i + Ops::W <= _n; i += Ops::W)
+            {
+                F x0 = uniformExclusive<Ops>(Ops::load(_io.rnd0 + i));
+                F sinTheta = Ops::sqrt(Ops::sub(Ops::splat(1.0f), x0));
+                F s, c;
+                details::fastSinCos2pi<Ops>(uniformExclusive<Ops>(Ops::load(_io.rnd1 + i)), s, c);
+                Ops::store(_io.x + i, Ops::mul(sinTheta, s));
+                Ops::store(_io.y + i, Ops::mul(sinTheta, c));
+                Ops::store(_io.z + i, Ops::sqrt(x0));
+            }
+            return i;
+        }
+    };
+
+    // Slope based sampling of the (anisotropic) GGX and Beckmann-Spizzichino
+    // distributions. _rnd0 gives the angle and _rnd1 the slope length.
+    struct DirMicrofacetKernel
+    {
+        float alphaX, alphaY;
+        bool beckmann;
+
+        template<typename Ops>
+        size_t run(const DirectionStreams& _io, size_t _begin, size_t _n) const
+        {
+            typedef typename Ops::F F;
+            const F one = Ops::splat(1.0f);
+            const F norm = Ops::splat(ei::PI * alphaX * alphaY);
+            size_t i = _begin;
+            for(; i + Ops::W <= _n; i += Ops::W)
+            {
+                F s, c;
+                details::fastSinCos2pi<Ops>(uniformExclusive<Ops>(Ops::load(_io.rnd0 + i)), s, c);
+                // The PDF is numerator / (norm * denominator * z³)
+                F e, numerator, denominator;
+                if(beckmann)
+                {
+                    F xi = Ops::add(uniformInclusive<Ops>(Ops::load(_io.rnd1 + i)), Ops::splat(1e-20f));
+                    e = Ops::sqrt(negate<Ops>(details::fastLog<Ops>(xi)));
+                    numerator = xi;
+                    denominator = norm;
+                } else {
+                    F xi = uniformExclusive<Ops>(Ops::load(_io.rnd1 + i));
+                    e = Ops::sqrt(Ops::div(xi, Ops::sub(one, xi)));
+                    F tmp = Ops::add(one, Ops::mul(e, e));
+                    numerator = one;
+                    denominator = Ops::mul(Ops::mul(norm, tmp), tmp);
+                }
+                F slopeX = Ops::mul(Ops::mul(e, c), Ops::splat(alphaX));
+                F slopeY = Ops::mul(Ops::mul(e, s), Ops::splat(alphaY));
+                F len = Ops::sqrt(Ops::add(Ops::add(Ops::mul(slopeX, slopeX), Ops::mul(slopeY, slopeY)), one));
+                F z = Ops::div(one, len);
+                Ops::store(_io.x + i, Ops::div(negate<Ops>(slopeX), len));
+                Ops::store(_io.y + i, Ops::div(negate<Ops>(slopeY), len));
+                Ops::store(_io.z + i, z);
+                if(_io.pdf)
+                {
+                    denominator = Ops::mul(Ops::mul(Ops::mul(denominator, z), z), z);
+                    Ops::store(_io.pdf + i, Ops::div(numerator, Ops::max(denominator, Ops::splat(1e-20f))));
+                }
+            }
+            return i;
+        }
+    };
+
+    // Henyey-Greenstein phase function (see PBRT book page 899) with the
+    // transformation into the frame of the incident direction. _rnd0 gives
+    // the angle and _rnd1 the deflection.
+    struct DirHenyeyGreensteinKernel
+    {
+        float g;
+        ei::Vec3 normal, tangent, bitangent;
+
+        template<typename Ops>
+        size_t run(const DirectionStreams& _io, size_t _begin, size_t _n) const
+        {
+            typedef typename Ops::F F;
+            const F one = Ops::splat(1.0f);
+            const bool isotropic = ei::abs(g) < 1e-3f;
+            const F gsq = Ops::splat(g * g);
+            size_t i = _begin;
+            for(; i + Ops::W <= _n; i += Ops::W)
+            {
+                F s, c;
+                details::fastSinCos2pi<Ops>(uniformExclusive<Ops>(Ops::load(_io.rnd0 + i)), s, c);
+                F u1 = uniformExclusive<Ops>(Ops::load(_io.rnd1 + i));
+                F cosTheta, pdf;
+                if(isotropic)
+                {
+                    cosTheta = Ops::sub(one, Ops::mul(Ops::splat(2.0f), u1));
+                    pdf = Ops::splat(1.0f / (4.0f * ei::PI));
+                } else {
+                    F sqTerm = Ops::div(Ops::splat(1.0f - g * g), Ops::add(Ops::splat(1.0f - g), Ops::mul(Ops::splat(2.0f * g), u1)));
+                    cosTheta = Ops::div(Ops::sub(Ops::add(one, gsq), Ops::mul(sqTerm, sqTerm)), Ops::splat(2.0f * g));
+                    pdf = Ops::div(Ops::splat(1.0f / (4.0f * ei::PI) * (1.0f - g * g)), Ops::mul(Ops::mul(sqTerm, sqTerm), sqTerm));
+                }
+                F sinTheta = Ops::sqrt(Ops::mul(Ops::sub(one, cosTheta), Ops::add(one, cosTheta)));
+                F x = Ops::mul(s, sinTheta);
+                F y = Ops::mul(c, sinTheta);
+                Ops::store(_io.x + i, Ops::add(Ops::mul(Ops::splat(normal.x), cosTheta), Ops::add(Ops::mul(Ops::splat(tangent.x), x), Ops::mul(Ops::splat(bitangent.x), y))));
+                Ops::store(_io.y + i, Ops::add(Ops::mul(Ops::splat(normal.y), cosTheta), Ops::add(Ops::mul(Ops::splat(tangent.y), x), Ops::mul(Ops::splat(bitangent.y), y))));
+                Ops::store(_io.z + i, Ops::add(Ops::mul(Ops::splat(normal.z), cosTheta), Ops::add(Ops::mul(Ops::splat(tangent.z), x), Ops::mul(Ops::splat(bitangent.z), y))));
+                if(_io.pdf)
+                    Ops::store(_io.pdf + i, pdf);
+            }
+            return i;
+        }
+    };
+
+#ifdef CN_RUNTIME_DISPATCH
+    template<typename Kernel>
+    CN_TARGET_ENTRY("sse2") static size_t sampleDirectionsSse2(const Kernel& _kernel, const DirectionStreams& _io, size_t _n)
+    {
+        return _kernel.template run<Sse2FloatOps>(_io, 0, _n);
+    }
+
+    template<typename Kernel>
+    CN_TARGET_ENTRY("avx2") static size_t sampleDirectionsAvx2(const Kernel& _kernel, const DirectionStreams& _io, size_t _n)
+    {
+        return _kernel.template run<Avx2FloatOps>(_io, 0, _n);
+    }
+#endif
+
+    template<typename Kernel>
+    static void sampleDirections(const Kernel& _kernel, const DirectionStreams& _io, size_t _n)
+    {
+        size_t i = 0;
+#ifdef CN_RUNTIME_DISPATCH
+        if(simdLevel() >= SimdLevel::AVX2)
+            i = sampleDirectionsAvx2(_kernel, _io, _n);
+        else if(simdLevel() >= SimdLevel::SSE2)
+            i = sampleDirectionsSse2(_kernel, _io, _n);
+#endif
+        _kernel.template run<details::ScalarFloatOps>(_io, i, _n);
+    }
+
+    void dirUniform(const ei::uint32* _rnd0, const ei::uint32* _rnd1, size_t _n, float* _x, float* _y, float* _z)
+    {
+        sampleDirections(DirUniformKernel(), DirectionStreams{_rnd0, _rnd1, _x, _y, _z, nullptr}, _n);
+    }
+
+    void dirCosine(const ei::uint32* _rnd0, const ei::uint32* _rnd1, size_t _n, float* _x, float* _y, float* _z)
+    {
+        sampleDirections(DirCosineKernel(), DirectionStreams{_rnd0, _rnd1, _x, _y, _z, nullptr}, _n);
+    }
+
+    void dirGGX(const ei::uint32* _rnd0, const ei::uint32* _rnd1, size_t _n, float _alpha, float* _x, float* _y, float* _z, float* _pdf)
+    {
+        sampleDirections(DirMicrofacetKernel{_alpha, _alpha, false}, DirectionStreams{_rnd0, _rnd1, _x, _y, _z, _pdf}, _n);
+    }
+
+    void dirGGX(const ei::uint32* _rnd0, const ei::uint32* _rnd1, size_t _n, const ei::Vec2& _alpha, float* _x, float* _y, float* _z, float* _pdf)
+    {
+        sampleDirections(DirMicrofacetKernel{_alpha.x, _alpha.y, false}, DirectionStreams{_rnd0, _rnd1, _x, _y, _z, _pdf}, _n);
+    }
+
+    void dirBeckmannSpizzichino(const ei::uint32* _rnd0, const ei::uint32* _rnd1, size_t _n, float _alpha, float* _x, float* _y, float* _z, float* _pdf)
+    {
+        sampleDirections(DirMicrofacetKernel{_alpha, _alpha, true}, DirectionStreams{_rnd0, _rnd1, _x, _y, _z, _pdf}, _n);
+    }
+
+    void dirBeckmannSpizzichino(const ei::uint32* _rnd0, const ei::uint32* _rnd1, size_t _n, const ei::Vec2& _alpha, float* _x, float* _y, float* _z, float* _pdf)
+    {
+        sampleDirections(DirMicrofacetKernel{_alpha.x, _alpha.y, true}, DirectionStreams{_rnd0, _rnd1, _x, _y, _z, _pdf}, _n);
+    }
+
+    void dirHenyeyGreenstein(const ei::uint32* _rnd0, const ei::uint32* _rnd1, size_t _n, float _g, const ShadingFrame& _incident, float* _x, float* _y, float* _z, float* _pdf)
+    {
+        DirHenyeyGreensteinKernel kernel{_g, _incident.normal(), _incident.tangent(), _incident.bitangent()};
+        sampleDirections(kernel, DirectionStreams{_rnd0, _rnd1, _x, _y, _z, _pdf}, _n);
+    }
+
+    // Product of the Cholesky factor with a block of standard normal samples
+    // (one sample per column of the normals). The rows of the factor are
+    // processed in groups of 4 which stay in the L1 cache while all samples
+    // of the block are transformed. The samples are traversed in tiles of
+    // two vectors, so each loaded normal is used for 4 rows and each
+    // broadcast factor for 2 vectors.
+    struct CholeskyKernel
+    {
+        const float* factor;
+        const float* mu;
+        const float* normals;
+        float* result;
+        size_t dim, dimPad;
+        size_t n;           // Number of samples and row stride of normals and result
+
+        template<typename Ops>
+        void run() const
+        {
+            for(size_t g = 0; g < dimPad; g += 4)
+            {
+                size_t k = 0;
+                for(; k + 2 * Ops::W <= n; k += 2 * Ops::W)
+                    tile<Ops, 2>(g, k);
+                for(; k + Ops::W <= n; k += Ops::W)
+                    tile<Ops, 1>(g, k);
+                for(; k < n; ++k)
+                    tile<details::ScalarFloatOps, 1>(g, k);
+            }
+        }
+
+        // Rows _g to _g+3 of the samples _k to _k + T*W (T = 1 or 2). The
+        // accumulators are named variables to keep them in registers.
+        template<typename Ops, int T>
+        void tile(size_t _g, size_t _k) const
+        {
+            typedef typename Ops::F F;
+            F a0 = Ops::splat(mu[_g]), a1 = Ops::splat(mu[_g + 1]), a2 = Ops::splat(mu[_g + 2]), a3 = Ops::splat(mu[_g + 3]);
+            F b0 = a0, b1 = a1, b2 = a2, b3 = a3;
+            // The factor is zero above the diagonal, so the last group of
+            // columns can be processed for all 4 rows.
+            const float* l = factor + _g * dimPad;
+            const float* z = normals + _k;
+            size_t end = ei::min(_g + 4, dim);
+            for(size_t j = 0; j < end; ++j, l += 4, z += n)
+            {
+                F za = Ops::loadF(z);
+                F l0 = Ops::splat(l[0]), l1 = Ops::splat(l[1]), l2 = Ops::splat(l[2]), l3 = Ops::splat(l[3]);
+                a0 = Ops::add(a0, Ops::mul(l0, za));
+                a1 = Ops::add(a1, Ops::mul(l1, za));
+                a2 = Ops::add(a2, Ops::mul(l2, za));
+                a3 = Ops::add(a3, Ops::mul(l3, za));
+                if(T == 2)
+                {
+                    F zb = Ops::loadF(z + Ops::W);
+                    b0 = Ops::add(b0, Ops::mul(l0, zb));
+                    b1 = Ops::add(b1, Ops::mul(l1, zb));
+                    b2 = Ops::add(b2, Ops::mul(l2, zb));
+                    b3 = Ops::add(b3, Ops::mul(l3, zb));
+                }
+            }
+            float* out = result + _g * n + _k;
+            Ops::store(out, a0);
+            Ops::store(out + n, a1);
+            Ops::store(out + 2 * n, a2);
+            Ops::store(out + 3 * n, a3);
+            if(T == 2)
+            {
+                Ops::store(out + Ops::W, b0);
+                Ops::store(out + n + Ops::W, b1);
+                Ops::store(out + 2 * n + Ops::W, b2);
+                Ops::store(out + 3 * n + Ops::W, b3);
+            }
+        }
+    };
+
+#ifdef CN_RUNTIME_DISPATCH
+    CN_TARGET_ENTRY("sse2") static void choleskySse2(const CholeskyKernel& _kernel)
+    {
+        _kernel.run<Sse2FloatOps>();
+    }
+
+    CN_TARGET_ENTRY("avx2") static void choleskyAvx2(const CholeskyKernel& _kernel)
+    {
+        _kernel.run<Avx2FloatOps>();
+    }
+#endif
+
+namespace details {
+
+    // Layer tables of the Ziggurat samplers from the setup in Marsaglia and
+    // Tsang "The Ziggurat Method for Generating Random Variables" (2000).
+    // Gaussian: 128 layers, r = 3.442619855899, v = 9.91256303526217e-3
+    const ei::uint32 ZIGGURAT_GAUSS_K[128] = {
+        0x76ad2212u, 0x00000000u, 0x600f1b53u, 0x6ce447a6u, 0x725b46a2u, 0x7560051du,
+        0x774921ebu, 0x789a25bdu, 0x799045c3u, 0x7a4bce5du, 0x7adf629fu, 0x7b5682a6u,
+        0x7bb8a8c6u, 0x7c0ae722u, 0x7c50cce7u, 0x7c8cec5bu, 0x7cc12cd6u, 0x7ceefed2u,
+        0x7d177e0bu, 0x7d3b8883u, 0x7d5bce6cu, 0x7d78dd64u, 0x7d932886u, 0x7dab0e57u,
+        0x7dc0dd30u, 0x7dd4d688u, 0x7de73185u, 0x7df81ceau, 0x7e07c0a3u, 0x7e163efau,
+        0x7e23b587u, 0x7e303dfdu, 0x7e3beec2u, 0x7e46db77u, 0x7e51155du, 0x7e5aabb3u,
+        0x7e63abf7u, 0x7e6c222cu, 0x7e741906u, 0x7e7b9a18u, 0x7e82adfau, 0x7e895c63u,
+        0x7e8fac4bu, 0x7e95a3fbu, 0x7e9b4924u, 0x7ea0a0efu, 0x7ea5b00du, 0x7eaa7ac3u,
+        0x7eaf04f3u, 0x7eb3522au, 0x7eb765a5u, 0x7ebb4259u, 0x7ebeeafdu, 0x7ec2620au,
+        0x7ec5a9c4u, 0x7ec8c441u, 0x7ecbb365u, 0x7ece78edu, 0x7ed11671u, 0x7ed38d62u,
+        0x7ed5df12u, 0x7ed80cb4u, 0x7eda175cu, 0x7edc0005u, 0x7eddc78eu, 0x7edf6ebfu,
+        0x7ee0f647u, 0x7ee25ebeu, 0x7ee3a8a9u, 0x7ee4d473u, 0x7ee5e276u, 0x7ee6d2f5u,
+        0x7ee7a620u, 0x7ee85c10u, 0x7ee8f4cdu, 0x7ee97047u, 0x7ee9ce59u, 0x7eea0ecau,
+        0x7eea3147u, 0x7eea3568u, 0x7eea1aabu, 0x7ee9e071u, 0x7ee98602u, 0x7ee90a88u,
+        0x7ee86d08u, 0x7ee7ac6au, 0x7ee6c769u, 0x7ee5bc9cu, 0x7ee48a67u, 0x7ee32efcu,
+        0x7ee1a857u, 0x7edff42fu, 0x7ede0ffau, 0x7edbf8d9u, 0x7ed9ab94u, 0x7ed7248du,
+        0x7ed45faeu, 0x7ed1585cu, 0x7ece095fu, 0x7eca6ccbu, 0x7ec67be2u, 0x7ec22eeeu,
+        0x7ebd7d1au, 0x7eb85c35u, 0x7eb2c075u, 0x7eac9c20u, 0x7ea5df27u, 0x7e9e769fu,
+        0x7e964c16u, 0x7e8d44bau, 0x7e834033u, 0x7e781728u, 0x7e6b9933u, 0x7e5d8a1au,
+        0x7e4d9dedu, 0x7e3b737au, 0x7e268c2fu, 0x7e0e3ff5u, 0x7df1aa5du, 0x7dcf8c72u,
+        0x7da61a1eu, 0x7d72a0fbu, 0x7d30e097u, 0x7cd9b4abu, 0x7c600f1au, 0x7ba90bdcu,
+        0x7a722176u, 0x77d664e5u
+    };
+    const float ZIGGURAT_GAUSS_W[128] = {
+        1.72904047e-09f, 1.26809285e-10f, 1.68975181e-10f, 1.98626879e-10f, 2.22324312e-10f, 2.42449366e-10f,
+        2.60161309e-10f, 2.76119877e-10f, 2.90739627e-10f, 3.04299697e-10f, 3.16997956e-10f, 3.28980204e-10f,
+        3.40357381e-10f, 3.51216028e-10f, 3.61625091e-10f, 3.71640579e-10f, 3.81308568e-10f, 3.90667582e-10f,
+        3.99750122e-10f, 4.08584e-10f, 4.17193086e-10f, 4.25598223e-10f, 4.33817593e-10f, 4.41867209e-10f,
+        4.49761312e-10f, 4.57512583e-10f, 4.65132405e-10f, 4.72631045e-10f, 4.80017748e-10f, 4.87300977e-10f,
+        4.94488506e-10f, 5.01587327e-10f, 5.08604048e-10f, 5.15544607e-10f, 5.22414667e-10f, 5.29219335e-10f,
+        5.35963496e-10f, 5.42651701e-10f, 5.49288171e-10f, 5.55876956e-10f, 5.62421887e-10f, 5.68926461e-10f,
+        5.75394121e-10f, 5.81828197e-10f, 5.88231686e-10f, 5.94607696e-10f, 6.00959005e-10f, 6.07288386e-10f,
+        6.13598505e-10f, 6.19892027e-10f, 6.26171337e-10f, 6.32439046e-10f, 6.38697373e-10f, 6.44948817e-10f,
+        6.51195597e-10f, 6.57440047e-10f, 6.6368433e-10f, 6.69930722e-10f, 6.76181444e-10f, 6.82438717e-10f,
+        6.88704649e-10f, 6.94981517e-10f, 7.01271485e-10f, 7.07576775e-10f, 7.13899662e-10f, 7.20242421e-10f,
+        7.26607274e-10f, 7.32996608e-10f, 7.39412809e-10f, 7.45858264e-10f, 7.52335472e-10f, 7.58846985e-10f,
+        7.65395414e-10f, 7.71983477e-10f, 7.78613951e-10f, 7.85289722e-10f, 7.92013788e-10f, 7.98789201e-10f,
+        8.05619238e-10f, 8.12507284e-10f, 8.19456891e-10f, 8.26471669e-10f, 8.33555558e-10f, 8.40712722e-10f,
+        8.47947323e-10f, 8.55264026e-10f, 8.62667549e-10f, 8.70163164e-10f, 8.77756201e-10f, 8.85452434e-10f,
+        8.9325819e-10f, 9.01179964e-10f, 9.09224973e-10f, 9.17400822e-10f, 9.25715837e-10f, 9.34178845e-10f,
+        9.42799727e-10f, 9.51588919e-10f, 9.60557855e-10f, 9.69719305e-10f, 9.79086923e-10f, 9.8867603e-10f,
+        9.98503613e-10f, 1.00858821e-09f, 1.01895092e-09f, 1.02961506e-09f, 1.04060693e-09f, 1.05195663e-09f,
+        1.06369802e-09f, 1.07587017e-09f, 1.08851828e-09f, 1.10169474e-09f, 1.11546106e-09f, 1.12989018e-09f,
+        1.14506959e-09f, 1.16110521e-09f, 1.1781276e-09f, 1.1962995e-09f, 1.21582866e-09f, 1.23698563e-09f,
+        1.26013233e-09f, 1.28576971e-09f, 1.31462019e-09f, 1.347784e-09f, 1.38706358e-09f, 1.4357403e-09f,
+        1.50086588e-09f, 1.60309477e-09f
+    };
+    const float ZIGGURAT_GAUSS_F[128] = {
+        1.0f, 0.963599682f, 0.936282694f, 0.913043618f, 0.892281651f, 0.873243034f,
+        0.855500579f, 0.838783622f, 0.822907209f, 0.807738304f, 0.793177009f, 0.779146075f,
+        0.765584171f, 0.752441585f, 0.73967725f, 0.727256894f, 0.715151489f, 0.70333612f,
+        0.69178915f, 0.680491865f, 0.669427693f, 0.658581972f, 0.647941828f, 0.637495458f,
+        0.627232492f, 0.617143393f, 0.607219517f, 0.597453177f, 0.58783704f, 0.57836467f,
+        0.569029987f, 0.559827387f, 0.550751805f, 0.541798353f, 0.53296268f, 0.524240553f,
+        0.515628219f, 0.50712204f, 0.498718649f, 0.490414828f, 0.482207656f, 0.474094301f,
+        0.466072142f, 0.458138704f, 0.450291634f, 0.442528725f, 0.434847832f, 0.427246988f,
+        0.419724345f, 0.412278026f, 0.404906422f, 0.397607863f, 0.3903808f, 0.383223802f,
+        0.376135468f, 0.369114459f, 0.362159491f, 0.355269372f, 0.348442972f, 0.341679156f,
+        0.334976852f, 0.328335106f, 0.321752906f, 0.315229386f, 0.308763623f, 0.302354842f,
+        0.29600215f, 0.289704859f, 0.283462197f, 0.277273506f, 0.271138072f, 0.265055299f,
+        0.25902456f, 0.253045291f, 0.247116953f, 0.241238996f, 0.235410944f, 0.229632318f,
+        0.223902702f, 0.21822165f, 0.212588772f, 0.207003713f, 0.201466113f, 0.195975646f,
+        0.190532044f, 0.185134992f, 0.179784268f, 0.174479634f, 0.169220895f, 0.164007857f,
+        0.158840373f, 0.153718308f, 0.148641571f, 0.143610075f, 0.138623774f, 0.133682653f,
+        0.128786713f, 0.123935983f, 0.119130544f, 0.11437051f, 0.109656021f, 0.104987256f,
+        0.100364439f, 0.0957878456f, 0.0912578031f, 0.0867746696f, 0.0823388994f, 0.0779509842f,
+        0.0736115053f, 0.0693211183f, 0.0650805831f, 0.0608907714f, 0.0567526631f, 0.0526674017f,
+        0.0486362949f, 0.0446608625f, 0.0407428667f, 0.0368843898f, 0.0330878869f, 0.0293563176f,
+        0.0256932918f, 0.022103304f, 0.0185921025f, 0.0151672978f, 0.0118394783f, 0.00862448476f,
+        0.00554899499f, 0.00266962918f
+    };
+    // Exponential: 256 layers, r = 7.697117470131487, v = 3.949659822581572e-3
+    const ei::uint32 ZIGGURAT_EXP_K[256] = {
+        0xe290a139u, 0x00000000u, 0x9beadebcu, 0xc377ac71u, 0xd4ddb990u, 0xde893fb8u,
+        0xe4a8e87cu, 0xe8dff16au, 0xebf2deabu, 0xee49a6e8u, 0xf0204efdu, 0xf19bdb8eu,
+        0xf2d458bbu, 0xf3da104bu, 0xf4b86d78u, 0xf577ad8au, 0xf61de83du, 0xf6afb784u,
+        0xf730a573u, 0xf7a37651u, 0xf80a5bb6u, 0xf867189du, 0xf8bb1b4fu, 0xf9079062u,
+        0xf94d70cau, 0xf98d8c7du, 0xf9c8928au, 0xf9ff175bu, 0xfa319996u, 0xfa6085f8u,
+        0xfa8c3a62u, 0xfab5084eu, 0xfadb36c8u, 0xfaff0410u, 0xfb20a6eau, 0xfb404fb4u,
+        0xfb5e2951u, 0xfb7a59e9u, 0xfb95038cu, 0xfbae44bau, 0xfbc638d8u, 0xfbdcf892u,
+        0xfbf29a30u, 0xfc0731dfu, 0xfc1ad1edu, 0xfc2d8b02u, 0xfc3f6c4du, 0xfc5083acu,
+        0xfc60ddd1u, 0xfc708662u, 0xfc7f8810u, 0xfc8decb4u, 0xfc9bbd62u, 0xfca9027cu,
+        0xfcb5c3c3u, 0xfcc20864u, 0xfccdd70au, 0xfcd935e3u, 0xfce42ab0u, 0xfceebaceu,
+        0xfcf8eb3bu, 0xfd02c0a0u, 0xfd0c3f59u, 0xfd156b7bu, 0xfd1e48d6u, 0xfd26daffu,
+        0xfd2f2552u, 0xfd372af7u, 0xfd3eeee5u, 0xfd4673e7u, 0xfd4dbc9eu, 0xfd54cb85u,
+        0xfd5ba2f2u, 0xfd62451bu, 0xfd68b415u, 0xfd6ef1dau, 0xfd750047u, 0xfd7ae120u,
+        0xfd809612u, 0xfd8620b4u, 0xfd8b8285u, 0xfd90bcf5u, 0xfd95d15eu, 0xfd9ac10bu,
+        0xfd9f8d36u, 0xfda43708u, 0xfda8bf9eu, 0xfdad2806u, 0xfdb17141u, 0xfdb59c46u,
+        0xfdb9a9fdu, 0xfdbd9b46u, 0xfdc170f6u, 0xfdc52bd8u, 0xfdc8ccacu, 0xfdcc542du,
+        0xfdcfc30bu, 0xfdd319efu, 0xfdd6597au, 0xfdd98245u, 0xfddc94e5u, 0xfddf91e6u,
+        0xfde279ceu, 0xfde54d1fu, 0xfde80c52u, 0xfdeab7deu, 0xfded5034u, 0xfdefd5beu,
+        0xfdf248e3u, 0xfdf4aa06u, 0xfdf6f984u, 0xfdf937b6u, 0xfdfb64f4u, 0xfdfd818du,
+        0xfdff8dd0u, 0xfe018a08u, 0xfe03767au, 0xfe05536cu, 0xfe07211cu, 0xfe08dfc9u,
+        0xfe0a8fabu, 0xfe0c30fbu, 0xfe0dc3ecu, 0xfe0f48b1u, 0xfe10bf76u, 0xfe122869u,
+        0xfe1383b4u, 0xfe14d17cu, 0xfe1611e7u, 0xfe174516u, 0xfe186b2au, 0xfe19843eu,
+        0xfe1a9070u, 0xfe1b8fd6u, 0xfe1c8289u, 0xfe1d689bu, 0xfe1e4220u, 0xfe1f0f26u,
+        0xfe1fcfbcu, 0xfe2083edu, 0xfe212bc3u, 0xfe21c745u, 0xfe225678u, 0xfe22d95fu,
+        0xfe234ffbu, 0xfe23ba4au, 0xfe241849u, 0xfe2469f2u, 0xfe24af3cu, 0xfe24e81eu,
+        0xfe25148bu, 0xfe253474u, 0xfe2547c7u, 0xfe254e70u, 0xfe25485au, 0xfe25356au,
+        0xfe251586u, 0xfe24e88fu, 0xfe24ae64u, 0xfe2466e1u, 0xfe2411dfu, 0xfe23af34u,
+        0xfe233eb4u, 0xfe22c02cu, 0xfe22336bu, 0xfe219838u, 0xfe20ee58u, 0xfe20358cu,
+        0xfe1f6d92u, 0xfe1e9621u, 0xfe1daef0u, 0xfe1cb7acu, 0xfe1bb002u, 0xfe1a9798u,
+        0xfe196e0du, 0xfe1832fdu, 0xfe16e5feu, 0xfe15869du, 0xfe141464u, 0xfe128ed3u,
+        0xfe10f565u, 0xfe0f478cu, 0xfe0d84b1u, 0xfe0bac36u, 0xfe09bd73u, 0xfe07b7b5u,
+        0xfe059a40u, 0xfe03644cu, 0xfe011504u, 0xfdfeab88u, 0xfdfc26e9u, 0xfdf98629u,
+        0xfdf6c83bu, 0xfdf3ec01u, 0xfdf0f04au, 0xfdedd3d1u, 0xfdea953du, 0xfde7331eu,
+        0xfde3abe9u, 0xfddffdfbu, 0xfddc2791u, 0xfdd826cdu, 0xfdd3f9a8u, 0xfdcf9dfcu,
+        0xfdcb1176u, 0xfdc65198u, 0xfdc15bb3u, 0xfdbc2ce2u, 0xfdb6c206u, 0xfdb117beu,
+        0xfdab2a63u, 0xfda4f5fdu, 0xfd9e7640u, 0xfd97a67au, 0xfd908192u, 0xfd8901f2u,
+        0xfd812182u, 0xfd78d98eu, 0xfd7022bbu, 0xfd66f4edu, 0xfd5d4732u, 0xfd530f9cu,
+        0xfd48432bu, 0xfd3cd59au, 0xfd30b936u, 0xfd23dea4u, 0xfd16349eu, 0xfd07a7a3u,
+        0xfcf8219bu, 0xfce7895bu, 0xfcd5c220u, 0xfcc2aadbu, 0xfcae1d5eu, 0xfc97ed4eu,
+        0xfc7fe6d4u, 0xfc65ccf3u, 0xfc495762u, 0xfc2a2fc8u, 0xfc07ee19u, 0xfbe213c1u,
+        0xfbb8051au, 0xfb890078u, 0xfb5411a5u, 0xfb180005u, 0xfad33482u, 0xfa839276u,
+        0xfa263b32u, 0xf9b72d1cu, 0xf930a1a2u, 0xf889f023u, 0xf7b577d2u, 0xf69c650cu,
+        0xf51530f0u, 0xf2cb0e3cu, 0xeeefb15du, 0xe6da6ecfu
+    };
+    const float ZIGGURAT_EXP_W[256] = {
+        2.02495554e-09f, 1.48667398e-11f, 2.44096167e-11f, 3.19688061e-11f, 3.84467701e-11f, 4.42282044e-11f,
+        4.9516443e-11f, 5.44335896e-11f, 5.90594379e-11f, 6.34494193e-11f, 6.76438142e-11f, 7.16729454e-11f,
+        7.55603219e-11f, 7.93245816e-11f, 8.29807889e-11f, 8.65413227e-11f, 9.00165151e-11f, 9.34150743e-11f,
+        9.67444319e-11f, 1.00010993e-10f, 1.03220314e-10f, 1.06377254e-10f, 1.09486115e-10f, 1.12550677e-10f,
+        1.15574349e-10f, 1.18560148e-10f, 1.21510829e-10f, 1.24428856e-10f, 1.27316477e-10f, 1.30175745e-10f,
+        1.33008535e-10f, 1.35816566e-10f, 1.38601422e-10f, 1.41364573e-10f, 1.44107379e-10f, 1.46831075e-10f,
+        1.49536869e-10f, 1.52225829e-10f, 1.54898996e-10f, 1.57557328e-10f, 1.60201713e-10f, 1.62833011e-10f,
+        1.65452027e-10f, 1.68059511e-10f, 1.7065617e-10f, 1.73242698e-10f, 1.75819734e-10f, 1.78387874e-10f,
+        1.80947743e-10f, 1.83499854e-10f, 1.86044763e-10f, 1.88582983e-10f, 1.91114985e-10f, 1.93641256e-10f,
+        1.96162225e-10f, 1.98678352e-10f, 2.01190037e-10f, 2.03697684e-10f, 2.06201681e-10f, 2.08702403e-10f,
+        2.11200224e-10f, 2.13695506e-10f, 2.16188553e-10f, 2.18679741e-10f, 2.21169361e-10f, 2.23657745e-10f,
+        2.261452e-10f, 2.28632016e-10f, 2.31118499e-10f, 2.33604941e-10f, 2.36091591e-10f, 2.3857874e-10f,
+        2.41066667e-10f, 2.4355562e-10f, 2.46045878e-10f, 2.4853769e-10f, 2.51031279e-10f, 2.53526949e-10f,
+        2.56024896e-10f, 2.58525396e-10f, 2.61028671e-10f, 2.63534944e-10f, 2.66044464e-10f, 2.68557454e-10f,
+        2.71074163e-10f, 2.73594786e-10f, 2.76119599e-10f, 2.78648771e-10f, 2.81182549e-10f, 2.83721185e-10f,
+        2.86264845e-10f, 2.88813806e-10f, 2.91368263e-10f, 2.93928409e-10f, 2.96494523e-10f, 2.99066771e-10f,
+        3.01645403e-10f, 3.04230641e-10f, 3.06822678e-10f, 3.09421766e-10f, 3.12028126e-10f, 3.14641951e-10f,
+        3.17263521e-10f, 3.19893001e-10f, 3.22530641e-10f, 3.25176691e-10f, 3.27831345e-10f, 3.30494854e-10f,
+        3.33167438e-10f, 3.35849376e-10f, 3.38540834e-10f, 3.41242118e-10f, 3.43953421e-10f, 3.46674994e-10f,
+        3.49407114e-10f, 3.52150031e-10f, 3.54903967e-10f, 3.57669172e-10f, 3.60445951e-10f, 3.63234554e-10f,
+        3.66035202e-10f, 3.6884823e-10f, 3.71673858e-10f, 3.74512393e-10f, 3.77364112e-10f, 3.80229292e-10f,
+        3.83108267e-10f, 3.86001286e-10f, 3.88908655e-10f, 3.91830707e-10f, 3.94767746e-10f, 3.97720079e-10f,
+        4.00688038e-10f, 4.03671957e-10f, 4.06672168e-10f, 4.09689005e-10f, 4.12722856e-10f, 4.15774054e-10f,
+        4.1884296e-10f, 4.21929935e-10f, 4.25035396e-10f, 4.28159702e-10f, 4.31303299e-10f, 4.34466518e-10f,
+        4.37649861e-10f, 4.40853687e-10f, 4.44078468e-10f, 4.4732465e-10f, 4.50592674e-10f, 4.53883015e-10f,
+        4.57196198e-10f, 4.60532668e-10f, 4.63892924e-10f, 4.6727755e-10f, 4.70686989e-10f, 4.74121908e-10f,
+        4.77582751e-10f, 4.81070184e-10f, 4.84584817e-10f, 4.8812715e-10f, 4.9169796e-10f, 4.95297747e-10f,
+        4.98927288e-10f, 5.0258725e-10f, 5.06278353e-10f, 5.10001319e-10f, 5.1375687e-10f, 5.1754584e-10f,
+        5.21369004e-10f, 5.25227251e-10f, 5.29121358e-10f, 5.33052213e-10f, 5.37020817e-10f, 5.41028056e-10f,
+        5.45074985e-10f, 5.49162493e-10f, 5.53291801e-10f, 5.57463853e-10f, 5.61679925e-10f, 5.65941072e-10f,
+        5.70248571e-10f, 5.74603698e-10f, 5.79007731e-10f, 5.83462112e-10f, 5.8796823e-10f, 5.92527583e-10f,
+        5.97141725e-10f, 6.01812211e-10f, 6.06540818e-10f, 6.11329209e-10f, 6.1617933e-10f, 6.21092955e-10f,
+        6.26072194e-10f, 6.31119157e-10f, 6.36235953e-10f, 6.41424969e-10f, 6.46688536e-10f, 6.52029264e-10f,
+        6.57449761e-10f, 6.62952859e-10f, 6.68541555e-10f, 6.74218792e-10f, 6.7998801e-10f, 6.85852597e-10f,
+        6.9181616e-10f, 6.97882585e-10f, 7.0405598e-10f, 7.10340675e-10f, 7.16741222e-10f, 7.23262561e-10f,
+        7.29909855e-10f, 7.36688599e-10f, 7.43604733e-10f, 7.50664531e-10f, 7.57874763e-10f, 7.65242647e-10f,
+        7.72775954e-10f, 7.80483012e-10f, 7.88372811e-10f, 7.96455069e-10f, 8.04740219e-10f, 8.13239642e-10f,
+        8.21965718e-10f, 8.30931879e-10f, 8.40152781e-10f, 8.49644521e-10f, 8.59424698e-10f, 8.6951274e-10f,
+        8.79930073e-10f, 8.90700458e-10f, 9.01850317e-10f, 9.13409182e-10f, 9.25410082e-10f, 9.37890432e-10f,
+        9.50892254e-10f, 9.64463842e-10f, 9.78660264e-10f, 9.93544802e-10f, 1.00919129e-09f, 1.02568598e-09f,
+        1.04313058e-09f, 1.06164655e-09f, 1.08137999e-09f, 1.10250964e-09f, 1.12525644e-09f, 1.14989862e-09f,
+        1.17679322e-09f, 1.20640897e-09f, 1.2393786e-09f, 1.27658495e-09f, 1.31931388e-09f, 1.36954348e-09f,
+        1.43054979e-09f, 1.50836499e-09f, 1.61608538e-09f, 1.79212478e-09f
+    };
+    const float ZIGGURAT_EXP_F[256] = {
+        1.0f, 0.938143671f, 0.900469959f, 0.87170434f, 0.847785473f, 0.826993287f,
+        0.808421671f, 0.791527629f, 0.775956869f, 0.761463404f, 0.747868598f, 0.735038102f,
+        0.722867668f, 0.711274743f, 0.70019263f, 0.689566493f, 0.679350555f, 0.669506311f,
+        0.660000861f, 0.650805831f, 0.641896725f, 0.633251965f, 0.624852717f, 0.616682172f,
+        0.608725369f, 0.600968957f, 0.593400896f, 0.586010337f, 0.578787386f, 0.571723044f,
+        0.564809203f, 0.558038294f, 0.551403403f, 0.544898212f, 0.538516879f, 0.532253861f,
+        0.526104212f, 0.520063162f, 0.51412642f, 0.508289754f, 0.502549529f, 0.496901989f,
+        0.491343856f, 0.485872f, 0.480483353f, 0.475175202f, 0.469944835f, 0.464789748f,
+        0.459707618f, 0.454696149f, 0.449753255f, 0.444876879f, 0.440065116f, 0.435316116f,
+        0.430628151f, 0.425999552f, 0.42142874f, 0.416914195f, 0.412454456f, 0.408048183f,
+        0.403694004f, 0.399390697f, 0.395136982f, 0.390931726f, 0.386773825f, 0.382662177f,
+        0.378595769f, 0.374573559f, 0.370594651f, 0.366658092f, 0.362762988f, 0.358908474f,
+        0.355093747f, 0.351318002f, 0.347580492f, 0.343880445f, 0.340217143f, 0.336589903f,
+        0.332998067f, 0.329440951f, 0.325917959f, 0.322428495f, 0.318971902f, 0.315547675f,
+        0.312155247f, 0.308794081f, 0.305463612f, 0.302163392f, 0.298892915f, 0.295651704f,
+        0.292439282f, 0.289255232f, 0.286099076f, 0.282970428f, 0.279868841f, 0.276793927f,
+        0.273745298f, 0.270722598f, 0.267725408f, 0.264753431f, 0.26180625f, 0.258883536f,
+        0.255985022f, 0.25311029f, 0.250259072f, 0.24743107f, 0.244625971f, 0.241843462f,
+        0.23908329f, 0.236345157f, 0.23362878f, 0.23093392f, 0.228260294f, 0.225607663f,
+        0.222975761f, 0.220364377f, 0.217773244f, 0.215202153f, 0.212650865f, 0.210119158f,
+        0.207606822f, 0.205113649f, 0.202639446f, 0.200183973f, 0.197747067f, 0.195328519f,
+        0.19292815f, 0.190545768f, 0.188181207f, 0.185834259f, 0.18350479f, 0.181192607f,
+        0.178897545f, 0.176619455f, 0.174358174f, 0.172113538f, 0.169885397f, 0.167673618f,
+        0.165478036f, 0.163298532f, 0.161134943f, 0.158987135f, 0.156854987f, 0.154738367f,
+        0.152637139f, 0.150551185f, 0.148480371f, 0.146424592f, 0.144383729f, 0.142357647f,
+        0.140346244f, 0.138349429f, 0.136367068f, 0.134399071f, 0.13244532f, 0.130505741f,
+        0.128580198f, 0.126668632f, 0.124770917f, 0.122886978f, 0.121016718f, 0.119160056f,
+        0.117316902f, 0.115487166f, 0.113670766f, 0.111867629f, 0.110077679f, 0.108300827f,
+        0.106537007f, 0.104786143f, 0.103048161f, 0.101323001f, 0.099610582f, 0.0979108512f,
+        0.0962237418f, 0.0945491865f, 0.0928871334f, 0.0912375152f, 0.0896002799f, 0.0879753754f,
+        0.0863627419f, 0.0847623274f, 0.0831740946f, 0.0815979838f, 0.0800339505f, 0.0784819499f,
+        0.0769419447f, 0.0754138902f, 0.0738977492f, 0.0723934844f, 0.0709010586f, 0.0694204345f,
+        0.0679515898f, 0.0664944947f, 0.0650491193f, 0.0636154339f, 0.0621934161f, 0.0607830472f,
+        0.059384305f, 0.0579971746f, 0.0566216409f, 0.0552576892f, 0.053905312f, 0.0525644943f,
+        0.0512352362f, 0.049917534f, 0.0486113839f, 0.0473167934f, 0.0460337624f, 0.0447622985f,
+        0.0435024127f, 0.0422541238f, 0.0410174429f, 0.0397923924f, 0.0385789946f, 0.037377283f,
+        0.0361872837f, 0.0350090377f, 0.0338425823f, 0.0326879621f, 0.031545233f, 0.0304144435f,
+        0.0292956606f, 0.0281889495f, 0.0270943847f, 0.0260120463f, 0.0249420255f, 0.0238844212f,
+        0.0228393357f, 0.0218068883f, 0.0207872037f, 0.0197804235f, 0.0187867004f, 0.0178062003f,
+        0.0168391075f, 0.0158856213f, 0.0149459681f, 0.0140203917f, 0.0131091652f, 0.0122125922f,
+        0.0113310134f, 0.0104648098f, 0.0096144136f, 0.00878031459f, 0.00796307717f, 0.00716335326f,
+        0.0063819061f, 0.00561964232f, 0.00487765577f, 0.00415729498f, 0.00346026476f, 0.00278879888f,
+        0.00214596768f, 0.00153629982f, 0.000967269298f, 0.000454134366f
+    };
+    void uniformBlock(const ei::uint32* _rnd, float* _out, size_t _n, float _scale, float _offset)
+    {
+        convert(UniformKernel{_scale, _offset}, _rnd, _out, _n);
+    }
+
+    void exponentialBlock(const ei::uint32* _rnd, float* _out, size_t _n, float _lambda)
+    {
+        convert(ExponentialKernel{-1.0f / _lambda}, _rnd, _out, _n);
+    }
+
+    // The block size is chosen such that the normals of a block fit into
+    // the L2 cache (64 KB), but at least 16 samples to fill the tiles.
+    CholeskyTransform::CholeskyTransform(const float* _sigmaSqrt, const float* _mu, size_t _dim) :
+        m_dim(_dim),
+        m_dimPad((_dim + 3) & ~size_t(3)),
+        m_blockSize(_dim >= 1024 ? 16 : ei::min(size_t(256), (16384 / (_dim + 1)) & ~size_t(15))),
+        m_factor(m_dimPad * m_dimPad, 0.0f),
+        m_mu(m_dimPad, 0.0f),
+        m_normals(_dim * m_blockSize),
+        m_result(m_dimPad * m_blockSize)
+    {
+        for(size_t i = 0; i < _dim; ++i)
+            for(size_t j = 0; j <= i; ++j)
+                m_factor[(i & ~size_t(3)) * m_dimPad + j * 4 + (i & 3)] = _sigmaSqrt[i * _dim + j];
+        if(_mu)
+            std::copy(_mu, _mu + _dim, m_mu.begin());
+    }
+
+    void CholeskyTransform::apply(size_t _n, float* _out)
+    {
+        CholeskyKernel kernel{m_factor.data(), m_mu.data(), m_normals.data(), m_result.data(), m_dim, m_dimPad, _n};
+#ifdef CN_RUNTIME_DISPATCH
+        if(simdLevel() >= SimdLevel::AVX2)
+            choleskyAvx2(kernel);
+        else if(simdLevel() >= SimdLevel::SSE2)
+            choleskySse2(kernel);
+        else
+            kernel.run<details::ScalarFloatOps>();
+#else
+        kernel.run<details::ScalarFloatOps>();
+#endif
+        // Transpose the result into rows of samples
+        for(size_t k = 0; k < _n; ++k)
+            for(size_t i = 0; i < m_dim; ++i)
+                _out[k * m_dim + i] = m_result[i * _n + k];
+    }
+
+    void gaussianBlock(const ei::uint32* _rnd, float* _out, size_t _n, float _sigma, float _mu)
+    {
+        GaussianKernel kernel{_sigma, _mu};
+        size_t i = _n - _n % GaussianKernel::GROUP;
+        convert(kernel, _rnd, _out, i);
+        // The last pair of an odd count is computed into a temporary
+        size_t numPairs = (_n - i) & ~size_t(1);
+        kernel.runPairs(_rnd + i, _out + i, numPairs);
+        if(_n & 1)
+        {
+            float pair[2];
+            kernel.runPairs(_rnd + _n - 1, pair, 2);
+            _out[_n - 1] = pair[0];
+        }
+    }
+
+    // Size of the blocks for the parallel table construction. The blocks do
+    // not depend on the number of threads, so the results are deterministic.
+    const size_t TABLE_BLOCK_SIZE = 1 << 16;
+
+    // Joins all threads when leaving the scope, also if starting a further
+    // thread throws (destroying a joinable std::thread terminates).
+    struct ThreadJoiner
+    {
+        std::vector<std::thread> threads;
+        ~ThreadJoiner()
+        {
+            for(auto& t : threads)
+                t.join();
+        }
+    };
+
+    // Call _func(i) for all i in [0, _n[ with up to _numThreads threads
+    // including the calling one (0 for all hardware threads). 1 runs serially
+    // without starting any thread.
+    template<typename Func>
+    static void parallelFor(size_t _n, uint32 _numThreads, Func _func)
+    {
+        size_t numThreads = _numThreads ? _numThreads : ei::max(1u, std::thread::hardware_concurrency());
+        numThreads = ei::min(numThreads, _n);
+        if(numThreads <= 1)
+        {
+            for(size_t i = 0; i < _n; ++i)
+                _func(i);
+            return;
+        }
+        std::atomic<size_t> next(0);
+        auto worker = [&]() {
+            for(size_t i = next++; i < _n; i = next++)
+                _func(i);
+        };
+        // Declared after the captured state, so the threads are joined before
+        // it is destroyed.
+        ThreadJoiner joiner;
+        joiner.threads.reserve(numThreads - 1);
+        for(size_t t = 1; t < numThreads; ++t)
+            joiner.threads.emplace_back(worker);
+        worker();
+    }
+
+    // _in and _out may be the same.
+    static double prefixSumBlock(const float* _in, float* _out, size_t _n, double _offset)
+    {
+        double sum = _offset;
+        for(size_t i = 0; i < _n; ++i)
+        {
+            sum += _in[i];
+            _out[i] = float(sum);
+        }
+        return sum;
+    }
+
+    // Guide entries for the CDF indices [_begin, _end[: index i is the guide
+    // of the buckets in ]bucket(cdf[i-1]), bucket(cdf[i])].
+    static void guideBlock(const GuidedCdf& _c, uint32* _guide, uint32 _begin, uint32 _end)
+    {
+        uint32 g = _begin == 0 ? 0 : _c.bucket(_c.cdf[_begin - 1]) + 1;
+        for(uint32 i = _begin; i < _end; ++i)
+        {
+            uint32 last = ei::min(_c.bucket(_c.cdf[i]), _c.size + 1);
+            for(; g <= last; ++g)
+                _guide[g] = i;
+        }
+    }
+
+    double prefixSum(float* _values, size_t _n, uint32 _numThreads)
+    {
+        size_t numBlocks = (_n + TABLE_BLOCK_SIZE - 1) / TABLE_BLOCK_SIZE;
+        if(numBlocks <= 1)
+            return prefixSumBlock(_values, _values, _n, 0.0);
+        // Sum of each block, then the prefix sums with the offsets of the
+        // previous blocks.
+        std::vector<double> offsets(numBlocks + 1, 0.0);
+        parallelFor(numBlocks, _numThreads, [&](size_t _b) {
+            size_t end = ei::min(_n, (_b + 1) * TABLE_BLOCK_SIZE);
+            double sum = 0.0;
+            for(size_t i = _b * TABLE_BLOCK_SIZE; i < end; ++i)
+                sum += _values[i];
+            offsets[_b + 1] = sum;
+        });
+        for(size_t b = 0; b < numBlocks; ++b)
+            offsets[b + 1] += offsets[b];
+        parallelFor(numBlocks, _numThreads, [&](size_t _b) {
+            size_t begin = _b * TABLE_BLOCK_SIZE;
+            prefixSumBlock(_values + begin, _values + begin, ei::min(_n - begin, TABLE_BLOCK_SIZE), offsets[_b]);
+        });
+        return offsets[numBlocks];
+    }
+
+    float GuidedCdf::buildGuide(const float* _cdf, uint32 _size, uint32* _guide, uint32 _numThreads)
+    {
+        GuidedCdf c{_cdf, _guide, _size, _cdf[_size-1] > 0.0f ? _size / _cdf[_size-1] : 0.0f};
+        uint32 numBlocks = uint32((_size + TABLE_BLOCK_SIZE - 1) / TABLE_BLOCK_SIZE);
+        if(numBlocks <= 1)
+            guideBlock(c, _guide, 0, _size);
+        else
+            parallelFor(numBlocks, _numThreads, [&](size_t _b) {
+                guideBlock(c, _guide, uint32(_b * TABLE_BLOCK_SIZE), uint32(ei::min(size_t(_size), (_b + 1) * TABLE_BLOCK_SIZE)));
+            });
+        // Buckets above the integral (from rounding) use the last entry
+        for(uint32 g = ei::min(c.bucket(_cdf[_size-1]), _size + 1) + 1; g < _size + 2; ++g)
+            _guide[g] = _size - 1;
+        return c.guideScale;
+    }
+
+} // namespace details
+
+    AliasTable1D::AliasTable1D(const std::vector<float>& _func) :
+        m_table(_func.size())
+    {
+        const size_t n = _func.size();
+        double sum = 0.0;
+        for(float f : _func) sum += f;
+        m_integral = float(sum / n);
+        // Split the entries into those below and above the mean (scaled
+        // probability 1). Each small entry is filled up by a large one,
+        // which becomes small itself if its remaining probability drops
+        // below 1.
+        std::vector<double> prob(n);
+        std::vector<ei::uint32> small, large;
+        for(size_t i = 0; i < n; ++i)
+        {
+            prob[i] = _func[i] * n / sum;
+            m_table[i].pdf = _func[i] / m_integral;
+            if(prob[i] < 1.0) small.push_back(ei::uint32(i));
+            else large.push_back(ei::uint32(i));
+        }
+        while(!small.empty() && !large.empty())
+        {
+            ei::uint32 s = small.back(); small.pop_back();
+            ei::uint32 l = large.back();
+            m_table[s].threshold = ei::uint32(prob[s] * 4294967296.0);
+            m_table[s].alias = int(l);
+            prob[l] -= 1.0 - prob[s];
+            if(prob[l] < 1.0)
+            {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        // Leftovers have a probability of 1 up to rounding errors and never
+        // use their alias.
+        for(ei::uint32 i : large) { m_table[i].threshold = 0xffffffffu; m_table[i].alias = int(i); }
+        for(ei::uint32 i : small) { m_table[i].threshold = 0xffffffffu; m_table[i].alias = int(i); }
+        for(auto& e : m_table)
+            e.aliasPdf = m_table[e.alias].pdf;
+    }
+
+    DynamicDiscreteFunction1D::DynamicDiscreteFunction1D(std::vector<float> _func) :
+        m_weights(std::move(_func))
+    {
+        build();
+    }
+
+    DynamicDiscreteFunction1D::DynamicDiscreteFunction1D(const DynamicDiscreteFunction1D& _other) :
+        m_weights(_other.m_weights)
+    {
+        build();
+    }
+
+    DynamicDiscreteFunction1D& DynamicDiscreteFunction1D::operator = (const DynamicDiscreteFunction1D& _other)
+    {
+        if(this != &_other)
+        {
+            m_weights = _other.m_weights;
+            build();
+        }
+        return *this;
+    }
+
+    void DynamicDiscreteFunction1D::build()
+    {
+        // Number of nodes per level until a single root remains. An empty
+        // function gets a root with a total of 0.
+        std::vector<size_t> levelNodes;
+        size_t numChildren = m_weights.size();
+        do {
+            numChildren = ei::max(size_t(1), (numChildren + 7) / 8);
+            levelNodes.push_back(numChildren);
+        } while(numChildren > 1);
+        size_t numValues = 0;
+        for(size_t n : levelNodes) numValues += n * 8;
+        // The new buffer has a different alignment than a previous one
+        std::vector<double>(numValues + 7).swap(m_nodes);
+        m_levels.clear();
+        size_t offset = (64 - reinterpret_cast<std::uintptr_t>(m_nodes.data()) % 64) % 64 / sizeof(double);
+        for(size_t n : levelNodes)
+        {
+            m_levels.push_back(offset);
+            offset += n * 8;
+        }
+        m_levels.push_back(offset);
+        for(size_t l = 0; l < levelNodes.size(); ++l)
+            for(size_t i = 0; i < levelNodes[l]; ++i)
+                updateNode(l, i);
+    }
+
+    void DynamicDiscreteFunction1D::updateNode(size_t _level, size_t _node)
+    {
+        double* p = m_nodes.data() + m_levels[_level] + _node * 8;
+        size_t first = _node * 8;
+        size_t numChildren = _level == 0 ? m_weights.size() : numNodes(_level - 1);
+        size_t end = ei::min(size_t(8), numChildren - first);
+        double sum = 0.0;
+        size_t k = 0;
+        if(_level == 0)
+        {
+            for(; k < end; ++k)
+                p[k] = sum += m_weights[first + k];
+        } else {
+            // The totals of the children are their last prefix sums
+            const double* child = m_nodes.data() + m_levels[_level - 1] + first * 8 + 7;
+            for(; k < end; ++k)
+                p[k] = sum += child[k * 8];
+        }
+        for(; k < 8; ++k)
+            p[k] = sum;
+    }
+
+    void DynamicDiscreteFunction1D::update(int _index, float _weight)
+    {
+        m_weights[_index] = _weight;
+        size_t node = size_t(_index) / 8;
+        for(size_t l = 0; l + 1 < m_levels.size(); ++l, node /= 8)
+            updateNode(l, node);
+    }
+
+    void DynamicDiscreteFunction1D::update(const int* _indices, const float* _weights, size_t _n)
+    {
+        // Single updates recompute about log8(size()) nodes each, a rebuild
+        // size() / 7 nodes.
+        size_t numLevels = m_levels.size() - 1;
+        if(_n * numLevels * 7 > m_weights.size())
+        {
+            for(size_t i = 0; i < _n; ++i)
+                m_weights[_indices[i]] = _weights[i];
+            for(size_t l = 0; l < numLevels; ++l)
+                for(size_t i = 0; i < numNodes(l); ++i)
+                    updateNode(l, i);
+        } else {
+            for(size_t i = 0; i < _n; ++i)
+                update(_indices[i], _weights[i]);
+        }
+    }
+
+    void DiscreteFunction2D::buildRows(const float* const* _values, Tables& _tables)
+    {
+        std::vector<Row>& rows = _tables.rows;
+        // Groups of rows with about TABLE_BLOCK_SIZE values each
+        size_t rowsPerTask = rows.empty() ? 1 : ei::max(size_t(1), details::TABLE_BLOCK_SIZE * rows.size() / ei::max(_tables.cdf.size(), size_t(1)));
+        size_t numTasks = (rows.size() + rowsPerTask - 1) / rowsPerTask;
+        details::parallelFor(numTasks, _tables.numThreads, [&](size_t _t) {
+            size_t end = ei::min(rows.size(), (_t + 1) * rowsPerTask);
+            for(size_t y = _t * rowsPerTask; y < end; ++y)
+            {
+                // The rows are built by a single thread each
+                Row& r = rows[y];
+                float* cdf = _tables.cdf.data() + r.offset;
+                double sum = details::prefixSumBlock(_values[y], cdf, r.size, 0.0);
+                _tables.rowIntegrals[y] = float(sum / r.size);
+                r.guideScale = details::GuidedCdf::buildGuide(cdf, r.size, _tables.guide.data() + r.guideOffset);
+            }
+        });
+    }
+
+} // namespace cn
@@ -0,0 +1,79 @@
+#pragma once
+
+// Helpers for the SIMD kernels of the library sources (not part of the
+// public interface).
+
+#ifdef _MSC_VER
+#   include <intrin.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#   include <immintrin.h>
+#   define CN_X86
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define CN_HAS_SSE2
+#endif
+
+// Kernels for instruction sets which are selected at runtime. The functions
+// are compiled for the given target independent of the compiler flags and
+// flatten inlines the complete kernel (template and SIMD wrapper) into the
+// entry function.
+#if defined(CN_X86) && (defined(__GNUC__) || defined(__clang__))
+#   define CN_TARGET(isa) __attribute__((target(isa)))
+#   define CN_TARGET_ENTRY(isa) __attribute__((target(isa), flatten))
+#   define CN_RUNTIME_DISPATCH
+#elif defined(CN_X86) && defined(_MSC_VER)
+#   define CN_TARGET(isa)
+#   define CN_TARGET_ENTRY(isa)
+#   define CN_RUNTIME_DISPATCH
+#endif
+
+#ifdef CN_RUNTIME_DISPATCH
+namespace cn {
+
+    // Best instruction set of the CPU we are running on.
+    enum class SimdLevel { SCALAR, SSE2, SSE41, AVX2, AVX512 };
+
+    inline SimdLevel detectSimdLevel()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        int maxLeaf = info[0];
+        __cpuid(info, 1);
+        bool sse2 = (info[3] & (1 << 26)) != 0;
+        bool sse41 = (info[2] & (1 << 19)) != 0;
+        // AVX requires OS support for the ymm/zmm registers (XGETBV)
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+        bool avx2 = false, avx512 = false;
+        if(maxLeaf >= 7 && (xcr0 & 0x6) == 0x6)
+        {
+            __cpuidex(info, 7, 0);
+            avx2 = (info[1] & (1 << 5)) != 0;
+            avx512 = (info[1] & (1 << 16)) != 0 && (xcr0 & 0xe6) == 0xe6;
+        }
+        if(avx512) return SimdLevel::AVX512;
+        if(avx2) return SimdLevel::AVX2;
+        if(sse41) return SimdLevel::SSE41;
+        if(sse2) return SimdLevel::SSE2;
+#else
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx512f")) return SimdLevel::AVX512;
+        if(__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+        if(__builtin_cpu_supports("sse4.1")) return SimdLevel::SSE41;
+        if(__builtin_cpu_supports("sse2")) return SimdLevel::SSE2;
+#endif
+        return SimdLevel::SCALAR;
+    }
+
+    // Detected once per program.
+    inline SimdLevel simdLevel()
+    {
+        static const SimdLevel LEVEL = detectSimdLevel();
+        return LEVEL;
+    }
+
+} // namespace cn
+#endif // CN_RUNTIME_DISPATCH
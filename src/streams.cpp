@@ -0,0 +1,49 @@
+#include "cn/streams.hpp"
+#include <atomic>
+
+namespace cn {
+
+    StreamFactory::StreamFactory(ei::uint64 _masterSeed) :
+        masterSeed(_masterSeed)
+    {
+    }
+
+    ei::uint64 StreamFactory::seed(ei::uint64 _streamId) const
+    {
+        // Two rounds of the Splitmix64 finalizer. The id is hashed first, so
+        // that consecutive ids and seeds do not give related keys.
+        Splitmix64Hash hash;
+        return hash(masterSeed ^ hash(_streamId + 0x9e3779b97f4a7c15ull));
+    }
+
+
+    static std::atomic<ei::uint64> g_threadRngSeed(0);
+    static std::atomic<ei::uint64> g_nextThreadStreamId(0);
+    static const ei::uint64 NO_STREAM_ID = ~0ull;
+    static thread_local ei::uint64 t_threadStreamId = NO_STREAM_ID;
+
+    void setThreadRngSeed(ei::uint64 _masterSeed)
+    {
+        g_threadRngSeed = _masterSeed;
+    }
+
+    void setThreadStreamId(ei::uint64 _streamId)
+    {
+        t_threadStreamId = _streamId;
+    }
+
+    ei::uint64 threadStreamId()
+    {
+        if(t_threadStreamId == NO_STREAM_ID)
+            t_threadStreamId = g_nextThreadStreamId++;
+        return t_threadStreamId;
+    }
+
+    namespace details {
+        ei::uint64 threadRngSeed()
+        {
+            return g_threadRngSeed;
+        }
+    }
+
+} // namespace cn
@@ -0,0 +1,434 @@
+#include <cn/rnd.hpp>
+#include <cn/fieldnoise.hpp>
+#include <cn/sampler.hpp>
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+using namespace cn;
+using namespace ei;
+
+// Number of generated numbers per measurement
+static const int BENCHMARK_N = 1 << 22;
+
+// Measure the time per number in nanoseconds for a functor which generates
+// BENCHMARK_N numbers into the given buffer.
+template<typename Func>
+static double measure(Func _func, std::vector<uint32>& _buffer)
+{
+    auto t0 = std::chrono::high_resolution_clock::now();
+    _func(_buffer.data());
+    auto t1 = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / BENCHMARK_N;
+}
+
+// Prevent the compiler from removing the generation.
+static uint32 checksum(const std::vector<uint32>& _buffer)
+{
+    uint32 sum = 0;
+    for(uint32 x : _buffer) sum ^= x;
+    return sum;
+}
+
+template<typename RNG>
+static void benchmarkFill(RNG _generator, const char* _name)
+{
+    std::vector<uint32> buffer(BENCHMARK_N);
+    RNG single = _generator;
+    double tSingle = measure([&](uint32* _out) {
+        for(int i = 0; i < BENCHMARK_N; ++i) _out[i] = single();
+    }, buffer);
+    uint32 sum = checksum(buffer);
+    double tFill = measure([&](uint32* _out) {
+        _generator.fill(_out, BENCHMARK_N);
+    }, buffer);
+    sum += checksum(buffer);
+    std::cout << "    " << _name << ": " << tSingle << " ns (operator()) / "
+        << tFill << " ns (fill) per number [" << sum << "]\n";
+}
+
+// Amortized cost of single numbers with and without BufferedRng.
+template<typename RNG>
+static void benchmarkBuffered(RNG _generator, const char* _name)
+{
+    std::vector<uint32> buffer(BENCHMARK_N);
+    RNG single = _generator;
+    double tSingle = measure([&](uint32* _out) {
+        for(int i = 0; i < BENCHMARK_N; ++i) _out[i] = single();
+    }, buffer);
+    uint32 sum = checksum(buffer);
+    BufferedRng<RNG> buffered(_generator);
+    double tBuffered = measure([&](uint32* _out) {
+        for(int i = 0; i < BENCHMARK_N; ++i) _out[i] = buffered();
+    }, buffer);
+    sum += checksum(buffer);
+    std::cout << "    " << _name << ": " << tSingle << " ns (unwrapped) / "
+        << tBuffered << " ns (BufferedRng) per number [" << sum << "]\n";
+}
+
+template<typename LaneRNG>
+static void benchmarkLanes(LaneRNG _generator, const char* _name)
+{
+    std::vector<uint32> buffer(BENCHMARK_N);
+    double t = measure([&](uint32* _out) {
+        for(int i = 0; i < BENCHMARK_N; i += LaneRNG::LANES)
+        {
+            auto x = _generator();
+            for(int j = 0; j < LaneRNG::LANES; ++j) _out[i+j] = x[j];
+        }
+    }, buffer);
+    std::cout << "    " << _name << ": " << t << " ns per number [" << checksum(buffer) << "]\n";
+}
+
+// Scalar calls against the batch function of a hash.
+template<typename Hasher>
+static void benchmarkHash(Hasher _hash, const char* _name)
+{
+    std::vector<uint32> input(BENCHMARK_N), buffer(BENCHMARK_N);
+    for(int i = 0; i < BENCHMARK_N; ++i) input[i] = i;
+    double tSingle = measure([&](uint32* _out) {
+        for(int i = 0; i < BENCHMARK_N; ++i) _out[i] = _hash(input[i]);
+    }, buffer);
+    uint32 sum = checksum(buffer);
+    double tBatch = measure([&](uint32* _out) {
+        _hash.hash(input.data(), _out, BENCHMARK_N);
+    }, buffer);
+    sum += checksum(buffer);
+    std::cout << "    " << _name << ": " << tSingle << " ns (operator()) / "
+        << tBatch << " ns (hash) per number [" << sum << "]\n";
+}
+
+// Digit by digit radical inverse as reference for the table driven engine.
+static uint32 digitRadicalInverse(uint32 _i, uint32 _base)
+{
+    uint32 result = 0;
+    uint32 f = uint32(0x100000000ull / _base);
+    while(_i > 0)
+    {
+        result += f * (_i % _base);
+        _i /= _base;
+        f /= _base;
+    }
+    return result;
+}
+
+static void benchmarkRadicalInverse()
+{
+    static const uint32 PRIMES[8] = {2, 3, 7, 31, 37, 67, 101, 131};
+    static const uint32 DIMS[8] = {0, 1, 3, 10, 11, 18, 25, 31};
+    std::vector<uint32> buffer(BENCHMARK_N);
+    HaltonRng halton(32);
+    std::cout << "Benchmark radical inverse (digit loop / at() / generateBlock):\n";
+    for(int k = 0; k < 8; ++k)
+    {
+        double tLoop = measure([&](uint32* _out) {
+            for(int i = 0; i < BENCHMARK_N; ++i) _out[i] = digitRadicalInverse(i, PRIMES[k]);
+        }, buffer);
+        uint32 sum = checksum(buffer);
+        double tAt = measure([&](uint32* _out) {
+            for(int i = 0; i < BENCHMARK_N; ++i) _out[i] = halton.at(i, DIMS[k]);
+        }, buffer);
+        sum += checksum(buffer);
+        double tBlock = measure([&](uint32* _out) {
+            HaltonRng(DIMS[k] + 1).generateBlock(0, BENCHMARK_N / (DIMS[k] + 1), _out);
+        }, buffer);
+        sum += checksum(buffer);
+        std::cout << "    base " << PRIMES[k] << ": " << tLoop << " / " << tAt << " / "
+            << tBlock << " ns per number [" << sum << "]\n";
+    }
+}
+
+// Throughput of StreamHash for a long buffer and the time for short keys.
+static void benchmarkStreamHash()
+{
+    std::vector<uint32> buffer(BENCHMARK_N);
+    for(int i = 0; i < BENCHMARK_N; ++i) buffer[i] = i;
+    uint64 sum = 0;
+    double tLong = measure([&](uint32* _data) {
+        sum += StreamHash().update(_data, BENCHMARK_N * sizeof(uint32)).finish64();
+    }, buffer);
+    std::vector<uint32> keys(BENCHMARK_N);
+    double tKeys = measure([&](uint32* _out) {
+        char key[] = "material/00000000";
+        for(int i = 0; i < BENCHMARK_N; ++i)
+        {
+            key[9] = char('0' + (i & 63));
+            key[10] = char('0' + ((i >> 6) & 63));
+            _out[i] = uint32(seedFromString(key));
+        }
+    }, keys);
+    sum += checksum(keys);
+    std::cout << "Benchmark StreamHash:\n    " << 4.0 / tLong << " GB/s (long buffer) / "
+        << tKeys << " ns per 17 byte key [" << sum << "]\n";
+}
+
+// Single sample functions against the batch samplers.
+static void benchmarkSamplers()
+{
+    std::vector<uint32> buffer(BENCHMARK_N);
+    std::vector<float> samples(BENCHMARK_N);
+    Xorshift32Rng rng(8237);
+    float sum = 0.0f;
+    auto report = [&](const char* _name, double _tSingle, double _tBatch) {
+        for(int i = 0; i < BENCHMARK_N; i += 4096) sum += samples[i];
+        std::cout << "    " << _name << ": " << _tSingle << " ns (single) / " << _tBatch << " ns (batch) per sample\n";
+    };
+    std::cout << "Benchmark samplers:\n";
+    double tSingle = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i) samples[i] = uniform(rng, -1.0f, 1.0f);
+    }, buffer);
+    double tBatch = measure([&](uint32*) { uniform(rng, samples.data(), BENCHMARK_N, -1.0f, 1.0f); }, buffer);
+    report("uniform", tSingle, tBatch);
+    tSingle = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i) samples[i] = gaussian(rng, 2.0f, 1.0f);
+    }, buffer);
+    tBatch = measure([&](uint32*) { gaussian(rng, samples.data(), BENCHMARK_N, 2.0f, 1.0f); }, buffer);
+    report("gaussian", tSingle, tBatch);
+    tSingle = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i) samples[i] = exponential(rng, 3.0f);
+    }, buffer);
+    tBatch = measure([&](uint32*) { exponential(rng, samples.data(), BENCHMARK_N, 3.0f); }, buffer);
+    report("exponential", tSingle, tBatch);
+    tSingle = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i) samples[i] = gaussianZiggurat(rng, 2.0f, 1.0f);
+    }, buffer);
+    for(int i = 0; i < BENCHMARK_N; i += 4096) sum += samples[i];
+    tBatch = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i) samples[i] = exponentialZiggurat(rng, 3.0f);
+    }, buffer);
+    for(int i = 0; i < BENCHMARK_N; i += 4096) sum += samples[i];
+    std::cout << "    Ziggurat: " << tSingle << " ns (gaussian) / " << tBatch << " ns (exponential) per sample\n";
+    std::vector<int> ints(BENCHMARK_N);
+    double tModulo = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i) ints[i] = uniform(rng, 0, 999);
+    }, buffer);
+    tSingle = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i) ints[i] = uniformInt(rng, 0, 999);
+    }, buffer);
+    tBatch = measure([&](uint32*) { uniformInt(rng, ints.data(), BENCHMARK_N, 0, 999); }, buffer);
+    for(int i = 0; i < BENCHMARK_N; i += 4096) sum += float(ints[i]);
+    std::cout << "    integers: " << tModulo << " ns (uniform) / " << tSingle << " ns (uniformInt) / " << tBatch << " ns (batch) per sample\n";
+    std::vector<uint32> rnd0(BENCHMARK_N), rnd1(BENCHMARK_N);
+    std::vector<float> x(BENCHMARK_N), y(BENCHMARK_N), z(BENCHMARK_N), pdf(BENCHMARK_N);
+    for(int i = 0; i < BENCHMARK_N; ++i) { rnd0[i] = rng(); rnd1[i] = rng(); }
+    tSingle = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i)
+        {
+            ei::Vec3 dir = dirGGX(rnd0[i], rnd1[i], 0.3f, pdf[i]);
+            x[i] = dir.x; y[i] = dir.y; z[i] = dir.z;
+        }
+    }, buffer);
+    for(int i = 0; i < BENCHMARK_N; i += 4096) sum += x[i] + pdf[i];
+    tBatch = measure([&](uint32*) {
+        dirGGX(rnd0.data(), rnd1.data(), BENCHMARK_N, 0.3f, x.data(), y.data(), z.data(), pdf.data());
+    }, buffer);
+    for(int i = 0; i < BENCHMARK_N; i += 4096) sum += x[i] + pdf[i];
+    std::cout << "    dirGGX: " << tSingle << " ns (single) / " << tBatch << " ns (batch) per sample\n";
+    tSingle = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i)
+        {
+            ei::Vec3 dir = dirUniform(rnd0[i], rnd1[i]);
+            x[i] = dir.x; y[i] = dir.y; z[i] = dir.z;
+        }
+    }, buffer);
+    for(int i = 0; i < BENCHMARK_N; i += 4096) sum += x[i];
+    tBatch = measure([&](uint32*) { dirUniform(rnd0.data(), rnd1.data(), BENCHMARK_N, x.data(), y.data(), z.data()); }, buffer);
+    for(int i = 0; i < BENCHMARK_N; i += 4096) sum += x[i];
+    std::cout << "    dirUniform: " << tSingle << " ns (single) / " << tBatch << " ns (batch) per sample\n";
+    // Correlated vectors: fixed size matrix per sample against the runtime
+    // dimension batch version
+    ei::Matrix<float, 16, 16> factor16(0.0f);
+    std::vector<float> factor(256 * 256, 0.0f);
+    for(int i = 0; i < 256; ++i)
+        for(int j = 0; j <= i; ++j)
+            factor[i * 256 + j] = (i == j) ? 1.0f : 0.01f * ((i + j) % 7);
+    for(int i = 0; i < 16; ++i)
+        for(int j = 0; j < 16; ++j)
+            factor16(i, j) = factor[i * 256 + j];
+    const ei::Vec<float, 16> mu16(0.5f);
+    tSingle = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N / 16; ++i)
+            *reinterpret_cast<ei::Vec<float, 16>*>(&samples[i * 16]) = gaussian(rng, factor16, mu16);
+    }, buffer);
+    for(int i = 0; i < BENCHMARK_N; i += 4096) sum += samples[i];
+    std::vector<float> factor16Rows(256);
+    for(int i = 0; i < 16; ++i)
+        for(int j = 0; j < 16; ++j)
+            factor16Rows[i * 16 + j] = factor[i * 256 + j];
+    tBatch = measure([&](uint32*) {
+        gaussian(rng, factor16Rows.data(), &mu16[0], 16, samples.data(), BENCHMARK_N / 16);
+    }, buffer);
+    for(int i = 0; i < BENCHMARK_N; i += 4096) sum += samples[i];
+    double tLarge = measure([&](uint32*) {
+        gaussian(rng, factor.data(), nullptr, 256, samples.data(), BENCHMARK_N / 256);
+    }, buffer);
+    for(int i = 0; i < BENCHMARK_N; i += 4096) sum += samples[i];
+    std::cout << "    multivariate gaussian: " << tSingle << " ns (16D single) / " << tBatch << " ns (16D batch) / "
+        << tLarge << " ns (256D batch) per vector component\n";
+
+    // Phase function samples about a fixed incident direction
+    const ei::Vec3 incident = ei::normalize(ei::Vec3(0.3f, -0.5f, 0.2f));
+    const ShadingFrame incidentFrame(incident);
+    double tBasis = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i) samples[i] = dirHenyeyGreenstein(rng, 0.7f, incident).x;
+    }, buffer);
+    double tFrame = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i) samples[i] = dirHenyeyGreenstein(rng, 0.7f, incidentFrame).x;
+    }, buffer);
+    for(int i = 0; i < BENCHMARK_N; i += 4096) sum += samples[i];
+    tBatch = measure([&](uint32*) {
+        dirHenyeyGreenstein(rnd0.data(), rnd1.data(), BENCHMARK_N, 0.7f, incidentFrame, x.data(), y.data(), z.data(), pdf.data());
+    }, buffer);
+    for(int i = 0; i < BENCHMARK_N; i += 4096) sum += x[i];
+    std::cout << "    dirHenyeyGreenstein: " << tBasis << " ns (basis per sample) / " << tFrame << " ns (ShadingFrame) / " << tBatch << " ns (batch) per sample\n";
+    // Precision policies of the single sample functions
+    double tPrecise = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i) samples[i] = gaussian(rng);
+    }, buffer);
+    double tFast = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i) samples[i] = gaussian<Xorshift32Rng, Fast>(rng);
+    }, buffer);
+    for(int i = 0; i < BENCHMARK_N; i += 4096) sum += samples[i];
+    std::cout << "    gaussian: " << tPrecise << " ns (Precise) / " << tFast << " ns (Fast) per sample\n";
+    tPrecise = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i) samples[i] = dirBeckmannSpizzichino(rng, 0.3f, pdf[i]).z;
+    }, buffer);
+    tFast = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i) samples[i] = dirBeckmannSpizzichino<Xorshift32Rng, Fast>(rng, 0.3f, pdf[i]).z;
+    }, buffer);
+    for(int i = 0; i < BENCHMARK_N; i += 4096) sum += samples[i];
+    std::cout << "    dirBeckmannSpizzichino: " << tPrecise << " ns (Precise) / " << tFast << " ns (Fast) per sample\n";
+    tPrecise = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i) samples[i] = dirCosine(rng, 20.0f).z;
+    }, buffer);
+    tFast = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i) samples[i] = dirCosine<Xorshift32Rng, Fast>(rng, 20.0f).z;
+    }, buffer);
+    for(int i = 0; i < BENCHMARK_N; i += 4096) sum += samples[i];
+    std::cout << "    dirCosine(n): " << tPrecise << " ns (Precise) / " << tFast << " ns (Fast) per sample\n";
+
+    // Discrete distributions with 100k entries
+    std::vector<float> func(100000);
+    for(size_t i = 0; i < func.size(); ++i)
+        func[i] = float((i * 2654435761u) % 1000);
+    DiscreteFunction1D cdfTable(func);
+    AliasTable1D aliasTable(func);
+    std::vector<int> indices(BENCHMARK_N);
+    double tCdf = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i) indices[i] = cdfTable.sampleDiscrete(rng);
+    }, buffer);
+    for(int i = 0; i < BENCHMARK_N; i += 4096) sum += indices[i];
+    double tAlias = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i) indices[i] = aliasTable.sampleDiscrete(rng);
+    }, buffer);
+    for(int i = 0; i < BENCHMARK_N; i += 4096) sum += indices[i];
+    std::cout << "    sampleDiscrete (100k entries): " << tCdf << " ns (DiscreteFunction1D) / " << tAlias << " ns (AliasTable1D) per sample\n";
+    // Changing 1000 of the 100k weights: rebuild against dynamic updates
+    DynamicDiscreteFunction1D dynTable(func);
+    const int NUM_REBUILDS = 20;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for(int k = 0; k < NUM_REBUILDS; ++k)
+    {
+        for(int i = 0; i < 1000; ++i) func[(i * 7919 + k) % func.size()] = float(i);
+        DiscreteFunction1D rebuilt(func);
+        sum += rebuilt.integral();
+    }
+    double tRebuild = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - t0).count() / NUM_REBUILDS;
+    t0 = std::chrono::high_resolution_clock::now();
+    for(int k = 0; k < NUM_REBUILDS; ++k)
+    {
+        for(int i = 0; i < 1000; ++i) dynTable.update(int((i * 7919 + k) % func.size()), float(i));
+        sum += dynTable.integral();
+    }
+    double tUpdate = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - t0).count() / NUM_REBUILDS;
+    double tDynamic = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i) indices[i] = dynTable.sampleDiscrete(rng);
+    }, buffer);
+    for(int i = 0; i < BENCHMARK_N; i += 4096) sum += indices[i];
+    std::cout << "    1000 weight changes (100k entries): " << tRebuild << " us (rebuild DiscreteFunction1D) / "
+        << tUpdate << " us (DynamicDiscreteFunction1D), " << tDynamic << " ns per sample\n";
+    // Environment map sized 2D distribution from a flat image
+    std::vector<float> image(2048 * 1024);
+    for(size_t i = 0; i < image.size(); ++i)
+        image[i] = float((i * 2654435761u) % 1000);
+    t0 = std::chrono::high_resolution_clock::now();
+    DiscreteFunction2D envMap(image.data(), 2048, 1024);
+    double tBuild = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+    std::vector<ei::Vec2> uv(BENCHMARK_N);
+    double t2D = measure([&](uint32*) {
+        for(int i = 0; i < BENCHMARK_N; ++i) uv[i] = envMap.sample(rng);
+    }, buffer);
+    for(int i = 0; i < BENCHMARK_N; i += 4096) sum += uv[i].x;
+    std::cout << "    DiscreteFunction2D (2048x1024): " << tBuild << " ms (construction) / " << t2D << " ns per sample\n";
+    std::cout << "    [" << sum << "]\n";
+}
+
+// Hash chain against the lattice hash in 3D Perlin noise.
+static void benchmarkNoise()
+{
+    std::vector<uint32> buffer(BENCHMARK_N);
+    ProspectorHash chain;
+    LatticeHash3D lattice;
+    const ei::IVec3 freq(64);
+    auto pos = [](int _i) { return ei::Vec3((_i & 255) / 256.0f, ((_i >> 8) & 255) / 256.0f, (_i >> 16) / 64.0f); };
+    double tChain = measure([&](uint32* _out) {
+        for(int i = 0; i < BENCHMARK_N; ++i)
+            _out[i] = uint32(perlinNoise<ProspectorHash,3>(chain, pos(i), freq, Interpolation::SMOOTHERSTEP, 7) * 1e6f);
+    }, buffer);
+    uint32 sum = checksum(buffer);
+    double tLattice = measure([&](uint32* _out) {
+        for(int i = 0; i < BENCHMARK_N; ++i)
+            _out[i] = uint32(perlinNoise<LatticeHash3D,3>(lattice, pos(i), freq, Interpolation::SMOOTHERSTEP, 7) * 1e6f);
+    }, buffer);
+    sum += checksum(buffer);
+    std::cout << "Benchmark 3D Perlin noise:\n    " << tChain << " ns (Prospector chain) / "
+        << tLattice << " ns (LatticeHash3D) per sample [" << sum << "]\n";
+}
+
+void benchmark_generators()
+{
+    uint32 stdSeed = WangHash()(83642);
+    std::cout << "Benchmark generators:\n";
+    benchmarkFill(Xorshift32Rng(stdSeed), "Xorshift32");
+    benchmarkFill(Rule30CARng(stdSeed), "Rule30");
+    benchmarkFill(MwcRng(stdSeed), "Mwc");
+    benchmarkFill(CmwcRng(stdSeed), "Cmwc");
+    benchmarkFill(Lfsr113Rng(stdSeed), "Lfsr113");
+    benchmarkFill(Well512Rng(stdSeed), "Well512");
+    benchmarkFill(Xoshiro256Rng(stdSeed), "Xoshiro256** (upper 32 bit)");
+    benchmarkFill(Pcg64Rng(stdSeed), "Pcg64 (upper 32 bit)");
+    benchmarkFill(Splitmix64Rng(stdSeed), "Splitmix64 (upper 32 bit)");
+    benchmarkFill(PhiloxRng(stdSeed), "Philox");
+    benchmarkFill(HaltonRng(8), "Halton");
+    benchmarkFill(HaltonRevRng(8), "HaltonRev");
+    benchmarkFill(AdditiveRecurrenceRng(8), "Additive Recurrence");
+    benchmarkFill(HammersleyRng(8, BENCHMARK_N / 8), "Hammersley");
+    benchmarkFill(SobolRng(8), "Sobol");
+    benchmarkLanes(Xorshift32x8Rng(stdSeed), "Xorshift32x8");
+    benchmarkLanes(Lfsr113x8Rng(stdSeed), "Lfsr113x8");
+    benchmarkLanes(Well512x4Rng(stdSeed), "Well512x4");
+    std::cout << "Benchmark BufferedRng:\n";
+    benchmarkBuffered(Xorshift32Rng(stdSeed), "Xorshift32");
+    benchmarkBuffered(Rule30CARng(stdSeed), "Rule30");
+    benchmarkBuffered(MwcRng(stdSeed), "Mwc");
+    benchmarkBuffered(CmwcRng(stdSeed), "Cmwc");
+    benchmarkBuffered(Lfsr113Rng(stdSeed), "Lfsr113");
+    benchmarkBuffered(Well512Rng(stdSeed), "Well512");
+    benchmarkBuffered(Xoshiro256Rng(stdSeed), "Xoshiro256**");
+    benchmarkBuffered(Pcg64Rng(stdSeed), "Pcg64");
+    benchmarkBuffered(Splitmix64Rng(stdSeed), "Splitmix64");
+    benchmarkBuffered(PhiloxRng(stdSeed), "Philox");
+    benchmarkBuffered(HaltonRng(8), "Halton");
+    benchmarkBuffered(SobolRng(8), "Sobol");
+    benchmarkRadicalInverse();
+    std::cout << "Benchmark batch hashing:\n";
+    benchmarkHash(KnuthHash(), "Knuth");
+    benchmarkHash(WangHash(), "Wang");
+    benchmarkHash(JenkinsHash(), "Jenkins");
+    benchmarkHash(Murmur32Hash(), "Murmur32");
+    benchmarkHash(ProspectorHash(), "Prospector");
+    benchmarkHash(ProspectorXHash(), "ProspectorX");
+    benchmarkStreamHash();
+    benchmarkSamplers();
+    benchmarkNoise();
+}
@@ -37,6 +37,51 @@ void test_distributions()
     if(uniform(ming, 3, 23869071) != 3)    std::cerr << "FAILED: uniform([3, 23869071]) does not generate 3 as expected.\n";
     if(uniform(maxg, 3, 23869071) != 23869071)    std::cerr << "FAILED: uniform([3, 23869071]) does not generate 23869071 as expected.\n";
 
+    // Unbiased integers
+    if(uniformInt(ming, 3, 9) != 3)    std::cerr << "FAILED: uniformInt([3, 9]) does not generate 3 as expected.\n";
+    if(uniformInt(maxg, 3, 9) != 9)    std::cerr << "FAILED: uniformInt([3, 9]) does not generate 9 as expected.\n";
+    if(uniformInt(maxg, -7, -2) != -2)    std::cerr << "FAILED: uniformInt([-7, -2]) does not generate -2 as expected.\n";
+    if(uniformInt(maxg, INT32_MIN, INT32_MAX) != -1)    std::cerr << "FAILED: uniformInt() of the full range does not return the number.\n";
+    if(uniformInt(maxg, int64(-5), int64(1) << 40) != int64(1) << 40)    std::cerr << "FAILED: uniformInt() 64 bit does not generate the maximum.\n";
+    if(uniformInt(ming, int64(-5), int64(1) << 40) != -5)    std::cerr << "FAILED: uniformInt() 64 bit does not generate the minimum.\n";
+    if(uniformInt(maxg, uint64(0), ~uint64(0)) != ~uint64(0))    std::cerr << "FAILED: uniformInt() of the full 64 bit range does not return the number.\n";
+    {
+        // Chi-square test with 6 degrees of freedom (99.9% quantile 22.46)
+        const int N = 700000;
+        int histScalar[7] = {0}, histBatch[7] = {0}, hist64[7] = {0};
+        std::vector<int16> batchInt(N);
+        Xorshift32Rng intRng(2087113);
+        uniformInt(intRng, batchInt.data(), N, int16(-3), int16(3));
+        for(int i = 0; i < N; ++i)
+        {
+            int x = uniformInt(intRng, 10, 16);
+            int64 y = uniformInt(intRng, int64(1) << 50, (int64(1) << 50) + 6);
+            if(x < 10 || x > 16 || batchInt[i] < -3 || batchInt[i] > 3 || y < (int64(1) << 50) || y > (int64(1) << 50) + 6)
+            { std::cerr << "FAILED: uniformInt() out of range.\n"; break; }
+            ++histScalar[x - 10];
+            ++histBatch[batchInt[i] + 3];
+            ++hist64[y - (int64(1) << 50)];
+        }
+        double chiScalar = 0.0, chiBatch = 0.0, chi64 = 0.0;
+        for(int i = 0; i < 7; ++i)
+        {
+            chiScalar += (histScalar[i] - N / 7.0) * (histScalar[i] - N / 7.0) / (N / 7.0);
+            chiBatch += (histBatch[i] - N / 7.0) * (histBatch[i] - N / 7.0) / (N / 7.0);
+            chi64 += (hist64[i] - N / 7.0) * (hist64[i] - N / 7.0) / (N / 7.0);
+        }
+        if(chiScalar > 22.46 || chiBatch > 22.46 || chi64 > 22.46)
+            std::cerr << "FAILED: uniformInt() is not uniform (chi^2 " << chiScalar << ", " << chiBatch << ", " << chi64 << ").\n";
+    }
+
+    // Full precision doubles
+    struct Max64Gen { uint64 next64() { return ~0ull; } uint32 operator () () { return 0xffffffff; } };
+    Max64Gen max64g;
+    if(uniformDouble(ming) != 0.0)    std::cerr << "FAILED: uniformDouble() does not generate 0 as expected.\n";
+    if(uniformDouble(maxg) != 1.0 - 1.0 / 9007199254740992.0)    std::cerr << "FAILED: uniformDouble() does not use 53 bits from two 32 bit numbers.\n";
+    if(uniformDouble(max64g) != 1.0 - 1.0 / 9007199254740992.0)    std::cerr << "FAILED: uniformDouble() does not use 53 bits from next64().\n";
+    if(uniformDouble(ming, -2.0, 5.0) != -2.0)    std::cerr << "FAILED: uniformDouble([-2, 5]) does not generate -2 as expected.\n";
+    if(uniformDouble(0x8000000000000000ull) != 0.5)    std::cerr << "FAILED: uniformDouble(2^63) is not 0.5.\n";
+
     if(lensq(dirUniform(ming)) > 1.0f)    std::cerr << "FAILED: direction() generated a too long vector.\n";
 
     // Test normal distribution
@@ -92,6 +137,181 @@ void test_distributions()
     if(!approx(mean, 0.2f, 1e-3f))     std::cerr << "FAILED: exponential() samples have a wrong mean.\n";
     if(!approx(var, 0.04f, 1e-3f))     std::cerr << "FAILED: exponential() samples have a wrong variance.\n";
 
+    // Batch samplers
+    std::vector<float> batch(1000001);
+    uniform(ming, batch.data(), 100);
+    if(batch[99] != 0.0f)    std::cerr << "FAILED: batch uniform() does not generate 0 as expected.\n";
+    uniform(maxg, batch.data(), 100, -1.0f, 2.0f);
+    if(batch[0] >= 2.0f || batch[99] >= 2.0f)    std::cerr << "FAILED: batch uniform([-1, 2[) generates 2.\n";
+    {
+        Xorshift32Rng copy = xorshiftRng;
+        uniform(xorshiftRng, batch.data(), 1000);
+        for(int i = 0; i < 1000; ++i)
+            if(batch[i] != (copy() >> 9) / 8388608.0f) { std::cerr << "FAILED: batch uniform() does not use the upper 23 bits.\n"; break; }
+    }
+    {
+        // Documented layout of 16 numbers: radii, angles -> cos samples, sin samples
+        Xorshift32Rng copy = xorshiftRng;
+        gaussian(xorshiftRng, batch.data(), 16, 1.0f, 0.0f);
+        uint32 rnd[16];
+        for(int i = 0; i < 16; ++i) rnd[i] = copy();
+        double maxErr = 0.0;
+        for(int i = 0; i < 8; ++i)
+        {
+            double r = sqrt(-2.0 * log(((rnd[i] >> 1) + 0.5) / 2147483648.0));
+            double phi = 6.283185307179586 * (rnd[i+8] >> 9) / 8388608.0;
+            maxErr = ei::max(maxErr, ei::abs(batch[i] - r * cos(phi)));
+            maxErr = ei::max(maxErr, ei::abs(batch[i+8] - r * sin(phi)));
+        }
+        if(maxErr > 1e-5)    std::cerr << "FAILED: batch gaussian() has an error of " << maxErr << '\n';
+    }
+    gaussian(xorshiftRng, batch.data(), batch.size(), 2.0f, -1.0f);
+    double bmean = 0.0, bvar = 0.0;
+    for(float x : batch) bmean += x;
+    bmean /= batch.size();
+    for(float x : batch) bvar += (x - bmean) * (x - bmean);
+    bvar /= batch.size() - 1;
+    if(!approx(float(bmean), -1.0f, 5e-3f))     std::cerr << "FAILED: batch gaussian() samples have a wrong mean.\n";
+    if(!approx(float(bvar), 4.0f, 2e-2f))     std::cerr << "FAILED: batch gaussian() samples have a wrong variance.\n";
+    // Integer literals select the single sample version
+    Xorshift32Rng literalRng(5531), literalCopy = literalRng;
+    if(gaussian(literalRng, 2, 1) != gaussian(literalCopy, 2.0f, 1.0f))
+        std::cerr << "FAILED: gaussian(gen, 0, 1) does not call the single sample version.\n";
+    exponential(xorshiftRng, batch.data(), batch.size(), 5.0f);
+    bmean = 0.0; bvar = 0.0;
+    for(float x : batch) bmean += x;
+    bmean /= batch.size();
+    for(float x : batch) bvar += (x - bmean) * (x - bmean);
+    bvar /= batch.size() - 1;
+    if(!approx(float(bmean), 0.2f, 1e-3f))     std::cerr << "FAILED: batch exponential() samples have a wrong mean.\n";
+    if(!approx(float(bvar), 0.04f, 1e-3f))     std::cerr << "FAILED: batch exponential() samples have a wrong variance.\n";
+    if(*std::min_element(batch.begin(), batch.end()) < 0.0f)     std::cerr << "FAILED: batch exponential() generates negative samples.\n";
+    {
+        // Runtime dimension multivariate gaussian: the same generator state
+        // with L = I yields the untransformed normals.
+        const size_t dim = 37, num = 1000;
+        std::vector<float> factor(dim * dim, 0.0f), identity(dim * dim, 0.0f), mu(dim);
+        for(size_t i = 0; i < dim; ++i)
+        {
+            for(size_t j = 0; j <= i; ++j)
+                factor[i * dim + j] = (i == j) ? 1.0f + i * 0.01f : ((i * 7 + j * 3) % 11) * 0.05f - 0.25f;
+            // Garbage in the upper triangle must be ignored
+            if(i + 1 < dim) factor[i * dim + i + 1] = 100.0f;
+            identity[i * dim + i] = 1.0f;
+            mu[i] = i * 0.5f - 3.0f;
+        }
+        Xorshift32Rng mvRng(51797), mvCopy = mvRng;
+        std::vector<float> normals(dim * num), samples(dim * num);
+        gaussian(mvCopy, identity.data(), nullptr, dim, normals.data(), num);
+        gaussian(mvRng, factor.data(), mu.data(), dim, samples.data(), num);
+        double maxErr = 0.0;
+        for(size_t k = 0; k < num; ++k)
+            for(size_t i = 0; i < dim; ++i)
+            {
+                double x = mu[i];
+                for(size_t j = 0; j <= i; ++j)
+                    x += factor[i * dim + j] * double(normals[k * dim + j]);
+                maxErr = ei::max(maxErr, ei::abs(samples[k * dim + i] - x));
+            }
+        if(maxErr > 1e-5)    std::cerr << "FAILED: batch multivariate gaussian() has an error of " << maxErr << '\n';
+        if(mvRng() != mvCopy())    std::cerr << "FAILED: batch multivariate gaussian() consumes a varying amount of random numbers.\n";
+
+        // Sample covariance of a 3D distribution
+        const float l3[9] = {2.0f, 0.0f, 0.0f,  1.0f, 1.0f, 0.0f,  -0.5f, 0.5f, 0.5f};
+        const size_t num3 = 300000;
+        std::vector<float> samples3(3 * num3);
+        gaussian(mvRng, l3, nullptr, 3, samples3.data(), num3);
+        double cov[3][3] = {{0.0}};
+        for(size_t k = 0; k < num3; ++k)
+            for(int i = 0; i < 3; ++i)
+                for(int j = 0; j < 3; ++j)
+                    cov[i][j] += samples3[k * 3 + i] * double(samples3[k * 3 + j]) / num3;
+        for(int i = 0; i < 3; ++i)
+            for(int j = 0; j < 3; ++j)
+            {
+                double expected = 0.0;
+                for(int m = 0; m < 3; ++m) expected += l3[i * 3 + m] * l3[j * 3 + m];
+                if(ei::abs(cov[i][j] - expected) > 3e-2)
+                    std::cerr << "FAILED: batch multivariate gaussian() has a wrong covariance (" << i << ',' << j << ").\n";
+            }
+    }
+
+    // Fast precision policy against Precise for the same random numbers
+    {
+        Xorshift32Rng precRng(7741);
+        float maxGauss = 0.0f, maxExp = 0.0f, maxDir = 0.0f, maxPdf = 0.0f;
+        auto dirError = [&](const Vec3& _a, const Vec3& _b) {
+            maxDir = max(maxDir, max(abs(_a.x - _b.x), max(abs(_a.y - _b.y), abs(_a.z - _b.z))));
+        };
+        for(int i = 0; i < 100000; ++i)
+        {
+            uint32 r0 = precRng(), r1 = precRng();
+            float pdfP, pdfF;
+            maxGauss = max(maxGauss, abs(gaussian<Fast>(r0, r1, 2.0f, 1.0f) - gaussian(r0, r1, 2.0f, 1.0f)));
+            maxExp = max(maxExp, abs(exponential<Fast>(r0, 2.0f) - exponential(r0, 2.0f)));
+            dirError(dirUniform<Fast>(r0, r1), dirUniform(r0, r1));
+            dirError(dirCosine<Fast>(r0, r1, 20.0f), dirCosine(r0, r1, 20.0f));
+            dirError(dirGGX<Fast>(r0, r1, 0.2f, pdfF), dirGGX(r0, r1, 0.2f, pdfP));
+            maxPdf = max(maxPdf, abs(pdfF - pdfP) / pdfP);
+            dirError(dirBeckmannSpizzichino<Fast>(r0, r1, Vec2(0.2f, 0.5f), pdfF), dirBeckmannSpizzichino(r0, r1, Vec2(0.2f, 0.5f), pdfP));
+            maxPdf = max(maxPdf, abs(pdfF - pdfP) / pdfP);
+            dirError(dirHenyeyGreenstein<Fast>(r0, r1, 0.6f, Vec3(0.0f, 0.6f, 0.8f)), dirHenyeyGreenstein(r0, r1, 0.6f, Vec3(0.0f, 0.6f, 0.8f)));
+        }
+        if(maxGauss > 1e-5f)    std::cerr << "FAILED: gaussian<Fast>() differs from gaussian() by " << maxGauss << ".\n";
+        if(maxExp > 1e-5f)    std::cerr << "FAILED: exponential<Fast>() differs from exponential() by " << maxExp << ".\n";
+        if(maxDir > 1e-5f)    std::cerr << "FAILED: Fast direction samplers differ from Precise by " << maxDir << ".\n";
+        if(maxPdf > 1e-4f)    std::cerr << "FAILED: Fast direction PDFs differ from Precise by " << maxPdf << " (relative).\n";
+        Vec2 fastMean(0.0f);
+        for(int i = 0; i < 100000; ++i)
+            fastMean += gaussian<Xorshift32Rng, 2, Fast>(precRng, Mat2x2(2.0f, 0.0f, 1.0f, 1.0f), Vec2(1.0f, -1.0f)) / 100000.0f;
+        if(!approx(fastMean.x, 1.0f, 0.03f) || !approx(fastMean.y, -1.0f, 0.03f))
+            std::cerr << "FAILED: multivariate gaussian<Fast>() has a wrong mean.\n";
+        // The generator type and the lane count come first, so explicit
+        // arguments from before the precision policies still work.
+        Xorshift32Rng explicitRng(991), explicitCopy = explicitRng;
+        Vec<uint32, 4> lanes0(1u, 2u, 3u, 4u), lanes1(5u, 6u, 7u, 8u);
+        if(gaussian<Xorshift32Rng>(explicitRng) != gaussian(explicitCopy)
+            || gaussian<4>(lanes0, lanes1)[2] != gaussian(3u, 7u)
+            || gaussian<Xorshift32Rng, Fast>(explicitRng) != gaussian<Fast>(explicitCopy(), explicitCopy()))
+            std::cerr << "FAILED: explicit template arguments select the wrong gaussian().\n";
+    }
+
+    // Ziggurat samplers: moments, some points of the CDF and the tails
+    {
+        const int N = 2000000;
+        double zmean = 0.0, zvar = 0.0;
+        int below1 = 0, aboveTail = 0;
+        for(int i = 0; i < N; ++i)
+        {
+            float x = gaussianZiggurat(xorshiftRng, 2.0f, -1.0f);
+            zmean += x; zvar += (x + 1.0) * (x + 1.0);
+            if(x < 1.0f) ++below1;          // P(X < mu + sigma) = 0.841345
+            if(x > 6.0f) ++aboveTail;       // P(X > mu + 3.5 sigma) = 2.326e-4
+        }
+        zmean /= N; zvar /= N;
+        if(!approx(float(zmean), -1.0f, 5e-3f))     std::cerr << "FAILED: gaussianZiggurat() samples have a wrong mean.\n";
+        if(!approx(float(zvar), 4.0f, 2e-2f))     std::cerr << "FAILED: gaussianZiggurat() samples have a wrong variance.\n";
+        if(ei::abs(below1 / double(N) - 0.841345) > 1e-3)     std::cerr << "FAILED: gaussianZiggurat() samples have a wrong distribution.\n";
+        if(ei::abs(aboveTail / double(N) - 2.326e-4) > 4e-5)     std::cerr << "FAILED: gaussianZiggurat() samples have a wrong tail.\n";
+
+        zmean = 0.0; zvar = 0.0;
+        int below02 = 0;
+        aboveTail = 0;
+        for(int i = 0; i < N; ++i)
+        {
+            float x = exponentialZiggurat(xorshiftRng, 5.0f);
+            zmean += x; zvar += (x - 0.2) * (x - 0.2);
+            if(x < 0.2f) ++below02;         // 1 - e^-1 = 0.632121
+            if(x > 1.6f) ++aboveTail;       // e^-8 = 3.355e-4 (beyond r = 7.7)
+            if(x < 0.0f) { std::cerr << "FAILED: exponentialZiggurat() generates negative samples.\n"; break; }
+        }
+        zmean /= N; zvar /= N;
+        if(!approx(float(zmean), 0.2f, 1e-3f))     std::cerr << "FAILED: exponentialZiggurat() samples have a wrong mean.\n";
+        if(!approx(float(zvar), 0.04f, 1e-3f))     std::cerr << "FAILED: exponentialZiggurat() samples have a wrong variance.\n";
+        if(ei::abs(below02 / double(N) - 0.632121) > 1e-3)     std::cerr << "FAILED: exponentialZiggurat() samples have a wrong distribution.\n";
+        if(ei::abs(aboveTail / double(N) - 3.355e-4) > 5e-5)     std::cerr << "FAILED: exponentialZiggurat() samples have a wrong tail.\n";
+    }
+
     // Test discrete function samplers
     float pdf;
     DiscreteFunction1D d1(std::vector<float>{1.3f, 1.3f, 1.3f});
@@ -111,6 +331,248 @@ void test_distributions()
     if(x < 0.0f || x > 1.0f) std::cerr << "FAILED: DiscreteFunction1D::sample out of interval (maxg).\n";
     if(!approx(pdf, 1.0f)) std::cerr << "FAILED: DiscreteFunction1D::sample pdf value wrong (maxg).\n";
 
+    {
+        // The guide table must give the same result as a binary search on
+        // the CDF, also with zeros and a wide range of values. The mapping
+        // of given numbers must be monotone and equal to the generator version.
+        std::vector<float> func(5000), cdf(5000);
+        double dsum = 0.0;
+        for(int i = 0; i < 5000; ++i)
+        {
+            func[i] = (i % 7 == 0 || (i > 2000 && i < 2500)) ? 0.0f : float((i * 7919) % 1000) * ((i % 3) ? 1.0f : 0.001f);
+            dsum += func[i];
+            cdf[i] = float(dsum);
+        }
+        const float sum = cdf.back();
+        DiscreteFunction1D guided(func);
+        Xorshift32Rng guideRng(33409);
+        bool wrongIndex = false, notMonotone = false, wrongSample = false;
+        int lastO = 0;
+        float lastX = 0.0f;
+        for(uint32 r = 0; r < 0xffff0000u; r += 0xffff)
+        {
+            int o = guided.sampleDiscrete(r);
+            float u = uniform(r, 0.0f, sum);
+            if(o != int(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin()))
+                wrongIndex = true;
+            float x = guided.sample(r);
+            if(o < lastO || x < lastX) notMonotone = true;
+            lastO = o; lastX = x;
+            Xorshift32Rng copy = guideRng;
+            uint32 rnd = guideRng();
+            int off;
+            if(guided.sample(copy, &pdf, &off) != guided.sample(rnd, nullptr) || off != guided.sampleDiscrete(rnd))
+                wrongSample = true;
+        }
+        // The upper end is found like with lower_bound (last positive entry)
+        if(guided.sampleDiscrete(0xffffffffu) != int(std::lower_bound(cdf.begin(), cdf.end(), sum) - cdf.begin()))
+            wrongIndex = true;
+        if(wrongIndex)    std::cerr << "FAILED: DiscreteFunction1D guide table gives a different index than the binary search.\n";
+        if(notMonotone)    std::cerr << "FAILED: DiscreteFunction1D::sample(uint32) is not monotone.\n";
+        if(wrongSample)    std::cerr << "FAILED: DiscreteFunction1D::sample(uint32) differs from the generator version.\n";
+
+        DiscreteFunction2D d2(std::vector<std::vector<float>>{{1.0f, 0.0f, 3.0f}, {0.0f}, {2.0f, 2.0f}});
+        Xorshift32Rng copy = guideRng;
+        uint32 r0 = guideRng(), r1 = guideRng();
+        float pdf2;
+        IVec2 off, off2;
+        Vec2 s = d2.sample(copy, &pdf, &off);
+        if(s != d2.sample(r0, r1, &pdf2, &off2) || pdf != pdf2 || off != off2 || off != d2.sampleDiscrete(r0, r1))
+            std::cerr << "FAILED: DiscreteFunction2D::sample(uint32, uint32) differs from the generator version.\n";
+
+        // Flat construction with a row stride against the nested vectors
+        std::vector<std::vector<float>> rows(7, std::vector<float>(5));
+        std::vector<float> image(7 * 8, -1.0f);
+        for(int y = 0; y < 7; ++y)
+            for(int x = 0; x < 5; ++x)
+                image[y * 8 + x] = rows[y][x] = float((x * 3 + y * 5) % 4);
+        DiscreteFunction2D nested(rows), flat(image.data(), 5, 7, 8);
+        if(nested.integral() != flat.integral())
+            std::cerr << "FAILED: DiscreteFunction2D from a float array has a different integral.\n";
+        bool different = false;
+        for(int i = 0; i < 1000; ++i)
+        {
+            r0 = guideRng(); r1 = guideRng();
+            s = nested.sample(r0, r1, &pdf, &off);
+            if(s != flat.sample(r0, r1, &pdf2, &off2) || pdf != pdf2 || off != off2 || rows[off.y][off.x] == 0.0f)
+                different = true;
+        }
+        if(different)    std::cerr << "FAILED: DiscreteFunction2D from a float array samples differently.\n";
+
+        // Large tables (built in parallel blocks). A float accumulation of
+        // 2^20 times 0.1 is off by several percent.
+        DiscreteFunction1D large(std::vector<float>(1 << 20, 0.1f));
+        if(!approx(large.integral(), 0.1f, 1e-6f))
+            std::cerr << "FAILED: DiscreteFunction1D has a wrong integral for a large function (" << large.integral() << ").\n";
+        bool wrongLarge = false;
+        for(uint32 k = 0; k < 1000; ++k)
+        {
+            uint32 idx = k * 1048 + 17;
+            if(ei::abs(large.sampleDiscrete(uint32((idx + 0.5) / (1 << 20) * 4294967295.0)) - int(idx)) > 1)
+                wrongLarge = true;
+        }
+        if(wrongLarge)    std::cerr << "FAILED: DiscreteFunction1D samples a large uniform function non-uniformly.\n";
+        // The result does not depend on the number of threads
+        std::vector<float> ramp(300000);
+        for(size_t i = 0; i < ramp.size(); ++i)
+            ramp[i] = float(i % 1000) * 0.01f;
+        DiscreteFunction1D serial(ramp), threaded(ramp, 3), allThreads(ramp, 0);
+        bool threadDependent = serial.integral() != threaded.integral() || serial.integral() != allThreads.integral();
+        for(uint32 k = 0; k < 1000; ++k)
+        {
+            uint32 rnd = k * 4294967u;
+            int idx = serial.sampleDiscrete(rnd);
+            if(threaded.sampleDiscrete(rnd) != idx || allThreads.sampleDiscrete(rnd) != idx)
+                threadDependent = true;
+        }
+        if(threadDependent)    std::cerr << "FAILED: DiscreteFunction1D depends on the number of threads.\n";
+        std::vector<std::vector<float>> largeRows(200, std::vector<float>(3000));
+        for(int y = 0; y < 200; ++y)
+            for(int x = 0; x < 3000; ++x)
+                largeRows[y][x] = float((x * 13 + y * 7) % 31);
+        DiscreteFunction2D large2D(largeRows);
+        bool wrongRow = false;
+        for(int i = 0; i < 200; ++i)
+        {
+            r0 = guideRng(); r1 = guideRng();
+            off = large2D.sampleDiscrete(r0, r1);
+            if(off.x != DiscreteFunction1D(largeRows[off.y]).sampleDiscrete(r1))
+                wrongRow = true;
+        }
+        if(wrongRow)    std::cerr << "FAILED: DiscreteFunction2D rows differ from DiscreteFunction1D.\n";
+        DiscreteFunction2D threaded2D(largeRows, 4);
+        bool threadDependent2D = threaded2D.integral() != large2D.integral();
+        for(int i = 0; i < 200; ++i)
+        {
+            r0 = guideRng(); r1 = guideRng();
+            if(threaded2D.sampleDiscrete(r0, r1) != large2D.sampleDiscrete(r0, r1))
+                threadDependent2D = true;
+        }
+        if(threadDependent2D)    std::cerr << "FAILED: DiscreteFunction2D depends on the number of threads.\n";
+
+        // Dynamic function: after updates (single and batch) the samples
+        // must follow the new weights, zeros are never sampled.
+        std::vector<float> dynWeights(777);
+        for(int i = 0; i < 777; ++i) dynWeights[i] = float(i % 5);
+        DynamicDiscreteFunction1D dyn(dynWeights);
+        for(int i = 0; i < 777; i += 3)
+        {
+            dynWeights[i] = float((i * 11) % 7);
+            dyn.update(i, dynWeights[i]);
+        }
+        std::vector<int> batchIdx;
+        std::vector<float> batchWeights;
+        for(int i = 1; i < 777; i += 2) { batchIdx.push_back(i); batchWeights.push_back(float(i % 9)); dynWeights[i] = float(i % 9); }
+        dyn.update(batchIdx.data(), batchWeights.data(), batchIdx.size());     // Rebuild
+        batchIdx.assign({5, 700, 776}); batchWeights.assign({20.0f, 0.0f, 3.5f});
+        dyn.update(batchIdx.data(), batchWeights.data(), 3);                    // Single updates
+        dynWeights[5] = 20.0f; dynWeights[700] = 0.0f; dynWeights[776] = 3.5f;
+        double dynSum = 0.0;
+        for(float w : dynWeights) dynSum += w;
+        if(!approx(dyn.integral(), float(dynSum / 777)))
+            std::cerr << "FAILED: DynamicDiscreteFunction1D::integral() is wrong after updates.\n";
+        std::vector<int> dynHist(777, 0);
+        bool dynInvalid = false;
+        const int N = 1000000;
+        for(int i = 0; i < N; ++i)
+        {
+            int o;
+            float x = dyn.sample(guideRng, &pdf, &o);
+            if(x < o / 777.0f || x > (o + 1) / 777.0f || !approx(pdf, float(dynWeights[o] * 777 / dynSum)))
+                dynInvalid = true;
+            ++dynHist[dyn.sampleDiscrete(guideRng)];
+        }
+        double chi = 0.0;
+        int zeroHits = 0, dof = -1;
+        for(int i = 0; i < 777; ++i)
+        {
+            if(dynWeights[i] == 0.0f) { zeroHits += dynHist[i]; continue; }
+            double expected = N * dynWeights[i] / dynSum;
+            chi += (dynHist[i] - expected) * (dynHist[i] - expected) / expected;
+            ++dof;
+        }
+        if(dynInvalid)    std::cerr << "FAILED: DynamicDiscreteFunction1D::sample produced an invalid sample or pdf.\n";
+        if(zeroHits)    std::cerr << "FAILED: DynamicDiscreteFunction1D samples entries with weight 0.\n";
+        // p = 0.001 for about 600 degrees of freedom
+        if(chi > dof + 3.1 * sqrt(2.0 * dof) + 10)
+            std::cerr << "FAILED: DynamicDiscreteFunction1D has a wrong distribution (chi^2 " << chi << " for " << dof << ").\n";
+        if(dynWeights[dyn.sampleDiscrete(0u)] == 0.0f || dyn.sampleDiscrete(0xffffffffu) != 776)
+            std::cerr << "FAILED: DynamicDiscreteFunction1D samples the boundaries wrongly.\n";
+        // Copies own a new node buffer and are independent of the original
+        DynamicDiscreteFunction1D dynCopy(dyn), dynAssigned(std::vector<float>{1.0f});
+        dynAssigned = dyn;
+        bool copyDifferent = dynCopy.integral() != dyn.integral() || dynAssigned.integral() != dyn.integral();
+        for(uint32 k = 0; k < 1000; ++k)
+        {
+            uint32 rnd = k * 4294967u;
+            int o = dyn.sampleDiscrete(rnd);
+            if(dynCopy.sampleDiscrete(rnd) != o || dynAssigned.sampleDiscrete(rnd) != o)
+                copyDifferent = true;
+        }
+        dynCopy.update(5, 0.0f);
+        if(dyn.weight(5) != 20.0f || !approx(dyn.integral(), float(dynSum / 777)))
+            copyDifferent = true;
+        if(copyDifferent)    std::cerr << "FAILED: DynamicDiscreteFunction1D copies sample differently or share their nodes.\n";
+        if(DynamicDiscreteFunction1D(std::vector<float>()).integral() != 0.0f)
+            std::cerr << "FAILED: An empty DynamicDiscreteFunction1D has a nonzero integral.\n";
+        // A single node: only the positive entry can be drawn, also after
+        // its weight moved to another entry.
+        DynamicDiscreteFunction1D tiny(std::vector<float>{0.0f, 0.0f, 2.0f});
+        if(tiny.sampleDiscrete(0u) != 2 || tiny.sampleDiscrete(0xffffffffu) != 2)
+            std::cerr << "FAILED: DynamicDiscreteFunction1D samples a zero weight in a single node.\n";
+        tiny.update(0, 1e-30f);
+        tiny.update(2, 0.0f);
+        if(tiny.sampleDiscrete(0u) != 0 || tiny.sampleDiscrete(0xffffffffu) != 0)
+            std::cerr << "FAILED: DynamicDiscreteFunction1D samples a zero weight after an update.\n";
+    }
+    {
+        // Alias table: distribution, zero entries, PDF and the position of
+        // continuous samples inside the chosen interval
+        std::vector<float> func(1000);
+        for(int i = 0; i < 1000; ++i)
+            func[i] = (i % 10 == 3) ? 0.0f : 1.0f + (i * 37) % 100;
+        double sum = 0.0;
+        for(float f : func) sum += f;
+        AliasTable1D alias(func);
+        if(!approx(alias.integral(), float(sum / 1000.0)))    std::cerr << "FAILED: AliasTable1D::integral() is wrong.\n";
+        Xorshift32Rng aliasRng(9137);
+        const int N = 2000000;
+        std::vector<int> hist(1000, 0);
+        bool invalid = false;
+        for(int i = 0; i < N; ++i)
+        {
+            int o;
+            float x = alias.sample(aliasRng, &pdf, &o);
+            if(o < 0 || o >= 1000 || x < o / 1000.0f || x > (o + 1) / 1000.0f || !approx(pdf, float(func[o] * 1000.0 / sum)))
+                invalid = true;
+            ++hist[alias.sampleDiscrete(aliasRng)];
+        }
+        if(invalid)    std::cerr << "FAILED: AliasTable1D::sample produced an invalid sample or pdf.\n";
+        double chi = 0.0;
+        int zeroHits = 0;
+        for(int i = 0; i < 1000; ++i)
+        {
+            double expected = N * func[i] / sum;
+            if(func[i] == 0.0f) zeroHits += hist[i];
+            else chi += (hist[i] - expected) * (hist[i] - expected) / expected;
+        }
+        // 899 degrees of freedom, p = 0.001
+        if(chi > 1044.0)    std::cerr << "FAILED: AliasTable1D::sampleDiscrete has a wrong distribution (chi^2 " << chi << ").\n";
+        if(zeroHits)    std::cerr << "FAILED: AliasTable1D::sampleDiscrete chooses entries with probability 0.\n";
+        for(uint32 r : {0u, 1u, 0x7fffffffu, 0xfffffffeu, 0xffffffffu})
+        {
+            int o = alias.sampleDiscrete(r);
+            x = alias.sample(r, &pdf);
+            if(o < 0 || o >= 1000 || func[o] == 0.0f || x < 0.0f || x > 1.0f || pdf <= 0.0f)
+                std::cerr << "FAILED: AliasTable1D produced an invalid sample for " << r << ".\n";
+        }
+        // The last fraction of a full entry (0x55555555 * 3 = 0xffffffff)
+        int fullOff;
+        x = AliasTable1D(std::vector<float>{1.0f, 1.0f, 1.0f}).sample(0x55555555u, &pdf, &fullOff);
+        if(!(x >= 0.0f && x <= 1.0f / 3.0f) || fullOff != 0 || !approx(pdf, 1.0f))
+            std::cerr << "FAILED: AliasTable1D produced an invalid sample for the last fraction of a full entry (" << x << ").\n";
+    }
+
     // The following are mere compiler test, because it is hard to check the
     // true distributions.
     for(float a = 0.0f; a <= 1.0f; a+=0.1f)
@@ -143,6 +605,82 @@ void test_distributions()
         dirOut = dirBeckmannSpizzichino(xorshiftRng, a, pdf);
         if(isnan(dirOut.x) || isnan(pdf)) std::cerr << "FAILED: dirBeckmannSpizzichino produces NaN directions or pdf.\n";
     }
+
+    // Batch directions against the single sample functions (with a count
+    // which is no multiple of the vector width and the extreme numbers).
+    {
+        const int N = 1003;
+        std::vector<uint32> rnd0(N), rnd1(N);
+        Xorshift32Rng dirRng(5521);
+        for(int i = 0; i < N; ++i) { rnd0[i] = dirRng(); rnd1[i] = dirRng(); }
+        rnd0[0] = rnd1[0] = rnd0[1] = rnd1[2] = 0;
+        rnd0[2] = rnd1[1] = rnd0[3] = rnd1[3] = 0xffffffff;
+        std::vector<float> bx(N), by(N), bz(N), bpdf(N);
+        auto compare = [&](const char* _name, auto _single, float _maxError) {
+            for(int i = 0; i < N; ++i)
+            {
+                float pdf = 0.0f;
+                Vec3 d = _single(rnd0[i], rnd1[i], pdf);
+                if(abs(d.x - bx[i]) > _maxError || abs(d.y - by[i]) > _maxError || abs(d.z - bz[i]) > _maxError
+                    || abs(pdf - bpdf[i]) > 1e-5f * pdf)
+                {
+                    std::cerr << "FAILED: batch " << _name << " differs from the single sample version.\n";
+                    return;
+                }
+            }
+        };
+        std::fill(bpdf.begin(), bpdf.end(), 0.0f);
+        dirUniform(rnd0.data(), rnd1.data(), N, bx.data(), by.data(), bz.data());
+        compare("dirUniform()", [](uint32 _r0, uint32 _r1, float&) { return dirUniform(_r0, _r1); }, 5e-7f);
+        dirCosine(rnd0.data(), rnd1.data(), N, bx.data(), by.data(), bz.data());
+        compare("dirCosine()", [](uint32 _r0, uint32 _r1, float&) { return dirCosine(_r0, _r1); }, 5e-7f);
+        for(float a : {0.05f, 0.4f, 1.0f})
+        {
+            dirGGX(rnd0.data(), rnd1.data(), N, a, bx.data(), by.data(), bz.data(), bpdf.data());
+            compare("dirGGX()", [a](uint32 _r0, uint32 _r1, float& _pdf) { return dirGGX(_r0, _r1, a, _pdf); }, 5e-7f);
+            dirGGX(rnd0.data(), rnd1.data(), N, Vec2(a, 0.5f), bx.data(), by.data(), bz.data(), bpdf.data());
+            compare("dirGGX() anisotropic", [a](uint32 _r0, uint32 _r1, float& _pdf) { return dirGGX(_r0, _r1, Vec2(a, 0.5f), _pdf); }, 5e-7f * max(a, 0.5f) / min(a, 0.5f));
+            dirBeckmannSpizzichino(rnd0.data(), rnd1.data(), N, a, bx.data(), by.data(), bz.data(), bpdf.data());
+            compare("dirBeckmannSpizzichino()", [a](uint32 _r0, uint32 _r1, float& _pdf) { return dirBeckmannSpizzichino(_r0, _r1, a, _pdf); }, 5e-7f);
+            dirBeckmannSpizzichino(rnd0.data(), rnd1.data(), N, Vec2(a, 0.5f), bx.data(), by.data(), bz.data(), bpdf.data());
+            compare("dirBeckmannSpizzichino() anisotropic", [a](uint32 _r0, uint32 _r1, float& _pdf) { return dirBeckmannSpizzichino(_r0, _r1, Vec2(a, 0.5f), _pdf); }, 5e-7f * max(a, 0.5f) / min(a, 0.5f));
+        }
+        const ShadingFrame incident(normalize(Vec3(0.3f, -0.5f, 0.2f)));
+        for(float g : {0.0f, 0.7f, -0.4f})
+        {
+            dirHenyeyGreenstein(rnd0.data(), rnd1.data(), N, g, incident, bx.data(), by.data(), bz.data(), bpdf.data());
+            compare("dirHenyeyGreenstein()", [g,&incident](uint32 _r0, uint32 _r1, float& _pdf) { return dirHenyeyGreenstein(_r0, _r1, g, incident, _pdf); }, 5e-7f);
+        }
+    }
+
+    // Sampling about a fixed frame
+    {
+        for(Vec3 n : {Vec3(0.0f, 0.0f, 1.0f), Vec3(0.0f, 0.0f, -1.0f), Vec3(1.0f, 0.0f, 0.0f), normalize(Vec3(-0.2f, 0.9f, 0.4f))})
+        {
+            ShadingFrame frame(n);
+            if(!approx(dot(frame.tangent(), frame.bitangent()), 0.0f) || !approx(dot(frame.tangent(), n), 0.0f)
+                || !approx(dot(frame.bitangent(), n), 0.0f) || !approx(lensq(frame.tangent()), 1.0f) || !approx(lensq(frame.bitangent()), 1.0f))
+                std::cerr << "FAILED: ShadingFrame is not orthonormal.\n";
+            Vec3 v(0.2f, -0.6f, 0.7f);
+            if(!approx(frame.toLocal(frame.toWorld(v)), v, 1e-5f))
+                std::cerr << "FAILED: ShadingFrame::toLocal() is not the inverse of toWorld().\n";
+            if(!approx(frame.toWorld(Vec3(0.0f, 0.0f, 1.0f)), n))
+                std::cerr << "FAILED: ShadingFrame does not map z to the normal.\n";
+            Xorshift32Rng rngA(91), rngB(91);
+            float pdfA, pdfB;
+            for(int i = 0; i < 100; ++i)
+            {
+                Vec3 a = dirHenyeyGreenstein(rngA, 0.5f, frame, pdfA);
+                Vec3 b = dirHenyeyGreenstein(rngB, 0.5f, n, pdfB);
+                if(a != b || pdfA != pdfB)
+                    std::cerr << "FAILED: dirHenyeyGreenstein() with a frame differs from the version with an incident vector.\n";
+                Vec3 local = dirGGX(rngA, 0.3f, pdfA);
+                Vec3 world = dirGGX(rngB, 0.3f, frame, pdfB);
+                if(!approx(world, frame.toWorld(local)) || pdfA != pdfB || !approx(dot(world, n), local.z, 1e-5f))
+                    std::cerr << "FAILED: dirGGX() with a frame is not the transformed tangent space sample.\n";
+            }
+        }
+    }
 }
 
 
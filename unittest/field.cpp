@@ -7,8 +7,65 @@ bool writePFM(const char* _name, int _size, const float* _data);
 
 using namespace cn;
 
+// The lattice hash path of the fields against a few invariants.
+static void testLatticeNoise()
+{
+    LatticeHash3D lattice;
+    const ei::IVec3 freq(8, 5, 3);
+
+    // All corners at once must be the same as the single point hash
+    uint32 h[8];
+    ei::IVec3 lo(7, 0, 2), hi(0, 1, 0);
+    lattice.corners(42, lo, hi, h);
+    for(int c = 0; c < 8; ++c)
+    {
+        ei::IVec3 p((c & 1) ? hi.x : lo.x, (c & 2) ? hi.y : lo.y, (c & 4) ? hi.z : lo.z);
+        if(h[c] != lattice(42, p))
+            std::cerr << "FAILED: LatticeHash3D corner " << c << " differs from the point hash.\n";
+    }
+
+    float maxGradErr = 0.0f;
+    for(int i = 0; i < 200; ++i)
+    {
+        ei::Vec3 x(i * 0.0371f, i * 0.0173f + 0.05f, i * 0.0093f + 0.11f);
+        x = x - ei::floor(x);
+        float v = valueNoise<LatticeHash3D,3>(lattice, x, freq, Interpolation::SMOOTHERSTEP, 11);
+        float p = perlinNoise<LatticeHash3D,3>(lattice, x, freq, Interpolation::SMOOTHERSTEP, 11);
+        if(v < 0.0f || v > 1.0f || p < 0.0f || p > 1.0f)
+            std::cerr << "FAILED: Lattice noise out of range: " << v << ", " << p << '\n';
+        // Periodic with the frequency
+        float vp = valueNoise<LatticeHash3D,3>(lattice, x + ei::Vec3(1.0f, 0.0f, 1.0f), freq, Interpolation::SMOOTHERSTEP, 11);
+        if(ei::abs(v - vp) > 1e-4f)
+            std::cerr << "FAILED: Lattice value noise is not periodic.\n";
+        // Gradient against finite differences
+        ei::Vec3 g(0.0f);
+        float pg = perlinNoiseG<LatticeHash3D,3>(lattice, x, freq, Interpolation::SMOOTHERSTEP, 11, g);
+        if(ei::abs(pg - p) > 1e-5f)
+            std::cerr << "FAILED: perlinNoiseG value differs from perlinNoise.\n";
+        for(int d = 0; d < 3; ++d)
+        {
+            ei::Vec3 e(0.0f); e[d] = 1e-3f;
+            float fd = (perlinNoise<LatticeHash3D,3>(lattice, x + e, freq, Interpolation::SMOOTHERSTEP, 11)
+                      - perlinNoise<LatticeHash3D,3>(lattice, x - e, freq, Interpolation::SMOOTHERSTEP, 11)) / 2e-3f;
+            // The gradient is relative to the scaled coordinates and not
+            // scaled by the 0.5 range mapping
+            maxGradErr = ei::max(maxGradErr, ei::abs(fd - g[d] * freq[d] * 0.5f) / (1.0f + ei::abs(fd)));
+        }
+    }
+    if(maxGradErr > 0.05f)
+        std::cerr << "FAILED: Lattice perlinNoiseG gradient error " << maxGradErr << '\n';
+
+    // At the lattice points the value noise is the hash itself
+    float v = valueNoise<LatticeHash3D,3>(lattice, ei::Vec3(3.0f / 8.0f, 2.0f / 5.0f, 1.0f / 3.0f) + 1e-6f, freq, Interpolation::LINEAR, 5);
+    float ref = (lattice(5, ei::IVec3(3, 2, 1)) & 0x00ffffff) / 16777215.0f;
+    if(ei::abs(v - ref) > 1e-3f)
+        std::cerr << "FAILED: Lattice value noise at a lattice point is " << v << " instead of " << ref << '\n';
+}
+
 void test_fields()
 {
+    testLatticeNoise();
+
     WangHash hasher;
 
     // Range tests
@@ -39,7 +96,7 @@ void test_fields()
         //image[x + y*512] = billowyTurbulence(hasher, perlinNoise<WangHash,2>, ei::Vec2(x / 512.0f, y / 512.0f), ei::IVec2(4), Interpolation::SMOOTHERSTEP, 29368, 6);
         //image[x + y*512] = ridgedTurbulence(hasher, perlinNoise<WangHash,2>, ei::Vec2(x / 512.0f, y / 512.0f), ei::IVec2(4), Interpolation::SMOOTHERSTEP, 29368, 6);
         //image[x + y*512] = swissTurbulence(hasher, perlinNoiseG<WangHash,2>, ei::Vec2(x / 512.0f, y / 512.0f), ei::IVec2(4), Interpolation::SMOOTHERSTEP, 29368, 6);
-        image[x + y*512] = jordanTurbulence(hasher, perlinNoiseG<WangHash,2>, ei::Vec2(x / 512.0f, y / 512.0f), ei::IVec2(4), Interpolation::SMOOTHERSTEP, 29368, 6);
+        image[x + y*512] = jordanTurbulence<WangHash,2>(hasher, perlinNoiseG<WangHash,2>, ei::Vec2(x / 512.0f, y / 512.0f), ei::IVec2(4), Interpolation::SMOOTHERSTEP, 29368, 6);
         /*ei::Vec2 g;
         float v = perlinNoiseG(hasher, ei::Vec2(x / 512.0f, y / 512.0f), ei::IVec2(4), Interpolation::SMOOTHERSTEP, 29368, g);
         image[x + y*512] = g.x;*/
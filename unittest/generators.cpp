@@ -1,8 +1,11 @@
 #include <cn/sampler.hpp>
+#include <cn/streams.hpp>
 #include <iostream>
 #include <vector>
 #include <fstream>
 #include <algorithm>
+#include <thread>
+#include <string>
 
 using namespace cn;
 using namespace ei;
@@ -118,6 +121,246 @@ float avalanche(Hasher _hash, uint32 N)
     return avalanche / 1024.0f;
 }
 
+// The bulk generation must produce the same sequence as single calls.
+template<typename RNG>
+static void testFill(RNG _generator, const char* _name)
+{
+    RNG single = _generator;
+    uint32 block[100];
+    _generator.fill(block, 100);
+    for(int i = 0; i < 100; ++i)
+        if(block[i] != single()) { std::cerr << "FAILED: " << _name << "::fill differs from operator().\n"; return; }
+    uint64 block64[10];
+    _generator.fill(block64, 10);
+    for(int i = 0; i < 10; ++i)
+    {
+        uint64 x = uint64(single()) << 32;
+        x |= single();
+        if(block64[i] != x) { std::cerr << "FAILED: " << _name << "::fill (64 bit) differs from operator().\n"; return; }
+    }
+}
+
+// Bulk generation of the 64 bit generators must be the same as next64()
+// (and as operator () for the 32 bit version).
+template<typename RNG>
+static void testFill64(RNG _generator, const char* _name)
+{
+    RNG single = _generator;
+    uint32 block[100];
+    _generator.fill(block, 100);
+    for(int i = 0; i < 100; ++i)
+        if(block[i] != single()) { std::cerr << "FAILED: " << _name << "::fill differs from operator().\n"; return; }
+    uint64 block64[100];
+    _generator.fill(block64, 100);
+    for(int i = 0; i < 100; ++i)
+        if(block64[i] != single.next64()) { std::cerr << "FAILED: " << _name << "::fill (64 bit) differs from next64().\n"; return; }
+}
+
+// Skipping numbers with discard() must give the same state as generating them.
+template<typename RNG>
+static void testDiscard(RNG _generator, const char* _name)
+{
+    for(uint64 n : {1ull, 37ull, 1000ull, 123457ull})
+    {
+        RNG stepped = _generator;
+        RNG skipped = _generator;
+        for(uint64 i = 0; i < n; ++i) stepped();
+        skipped.discard(n);
+        for(int i = 0; i < 16; ++i)
+            if(stepped() != skipped()) { std::cerr << "FAILED: " << _name << "::discard(" << n << ") differs from generating the numbers.\n"; return; }
+    }
+}
+
+// jump(n) must give the same state as n calls of jump().
+template<typename RNG>
+static void testJump(RNG _generator, const char* _name)
+{
+    for(uint64 n : {0ull, 1ull, 2ull, 5ull, 37ull})
+    {
+        RNG stepped = _generator;
+        RNG skipped = _generator;
+        for(uint64 i = 0; i < n; ++i) stepped.jump();
+        skipped.jump(n);
+        for(int i = 0; i < 16; ++i)
+            if(stepped() != skipped()) { std::cerr << "FAILED: " << _name << "::jump(" << n << ") differs from single jumps.\n"; return; }
+    }
+}
+
+// Random access of a Quasi-RNG must be consistent with the interleaved stream.
+// _firstIndex: sample index of the first number of the stream.
+template<typename RNG>
+static void testRandomAccess(RNG _generator, uint32 _numBases, uint32 _firstIndex, const char* _name)
+{
+    std::vector<uint32> block(_numBases * 20);
+    _generator.generateBlock(_firstIndex, 20, block.data());
+    uint32 point[64];
+    for(uint32 i = 0; i < 20; ++i)
+    {
+        _generator.point(_firstIndex + i, point);
+        for(uint32 d = 0; d < _numBases; ++d)
+        {
+            uint32 x = _generator();
+            if(x != _generator.at(_firstIndex + i, d) || x != point[d] || x != block[d * 20 + i])
+            {
+                std::cerr << "FAILED: " << _name << " random access differs from the sequence.\n";
+                return;
+            }
+        }
+    }
+}
+
+// Straightforward digit loop to validate the table driven radical inverse.
+static uint32 referenceRadicalInverse(uint32 _i, uint32 _base, bool _reverse)
+{
+    uint32 result = 0;
+    uint32 f = uint32(0x100000000ull / _base);
+    while(_i > 0)
+    {
+        uint32 d = _i % _base;
+        if(_reverse && d) d = _base - d;
+        result += f * d;
+        _i /= _base;
+        f /= _base;
+    }
+    return result;
+}
+
+template<typename RNG>
+static void testRadicalInverse(RNG _generator, bool _reverse, const char* _name)
+{
+    static const uint32 PRIMES[32] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53,
+        59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131};
+    // Sequential blocks around large indices to cover the carry propagation
+    const uint32 FIRST[4] = {0, 1000000, 0x7fffff00, 0xffffff00};
+    std::vector<uint32> block(32 * 256);
+    for(uint32 first : FIRST)
+    {
+        _generator.generateBlock(first, 256, block.data());
+        for(uint32 d = 0; d < 32; ++d)
+            for(uint32 i = 0; i < 256; ++i)
+            {
+                uint32 expected = referenceRadicalInverse(first + i, PRIMES[d], _reverse);
+                if(_generator.at(first + i, d) != expected || block[d * 256 + i] != expected)
+                {
+                    std::cerr << "FAILED: " << _name << " radical inverse in base " << PRIMES[d] << " is wrong.\n";
+                    return;
+                }
+            }
+    }
+}
+
+// Each lane of a multi-lane generator must reproduce the scalar generator.
+template<typename LaneRNG, typename RNG>
+static void testLanes(LaneRNG _generator, std::vector<RNG> _scalar, const char* _name)
+{
+    for(int k = 0; k < 100; ++k)
+    {
+        auto x = _generator();
+        for(int i = 0; i < LaneRNG::LANES; ++i)
+            if(x[i] != _scalar[i]()) { std::cerr << "FAILED: " << _name << " lane " << i << " differs from the scalar generator.\n"; return; }
+    }
+}
+
+// Batch hashing must give the same results as the scalar hash (for all
+// lengths and alignments).
+template<typename Hasher, typename T>
+static void testBatchHash(Hasher _hash, T _seed, const char* _name)
+{
+    std::vector<T> in(301), out(301);
+    for(size_t i = 0; i < in.size(); ++i)
+        in[i] = T(_seed * (i + 1) + i);
+    for(size_t offset = 0; offset < 3; ++offset)
+        for(size_t n = 0; n < 300 - offset; n += 37)
+        {
+            _hash.hash(in.data() + offset, out.data() + offset, n);
+            for(size_t i = offset; i < offset + n; ++i)
+                if(out[i] != _hash(in[i])) { std::cerr << "FAILED: " << _name << "::hash differs from operator ().\n"; return; }
+        }
+    // In place
+    std::vector<T> copy = in;
+    _hash.hash(copy.data(), copy.data(), copy.size());
+    for(size_t i = 0; i < in.size(); ++i)
+        if(copy[i] != _hash(in[i])) { std::cerr << "FAILED: " << _name << "::hash in place differs from operator ().\n"; return; }
+}
+
+// The stream hash must not depend on the splitting of the data and flipping
+// any input bit must change about half of the output bits.
+static void testStreamHash()
+{
+    std::vector<uint8> data(1000);
+    for(size_t i = 0; i < data.size(); ++i)
+        data[i] = uint8(WangHash()(uint32(i)));
+    for(size_t n : {0, 1, 15, 16, 17, 63, 64, 65, 300, 1000})
+    {
+        StreamHash whole(7);
+        whole.update(data.data(), n);
+        for(size_t chunk : {1, 3, 16, 29, 100})
+        {
+            StreamHash parts(7);
+            for(size_t i = 0; i < n; i += chunk)
+                parts.update(data.data() + i, std::min(chunk, n - i));
+            if(parts.finish() != whole.finish() || parts.finish64() != whole.finish64())
+            { std::cerr << "FAILED: StreamHash depends on the splitting of the data.\n"; return; }
+        }
+    }
+    // Zero padding must not collide
+    uint8 zeros[2] = {0, 0};
+    if(StreamHash().update(zeros, 1).finish64() == StreamHash().update(zeros, 2).finish64())
+        std::cerr << "FAILED: StreamHash of different lengths collide.\n";
+    double flipped = 0.0;
+    int numTests = 0;
+    for(size_t n : {4, 40, 200})
+        for(size_t bit = 0; bit < n * 8; bit += 3)
+        {
+            uint64 a = seedFrom(data.data(), n);
+            data[bit / 8] ^= uint8(1 << (bit % 8));
+            uint64 b = seedFrom(data.data(), n);
+            data[bit / 8] ^= uint8(1 << (bit % 8));
+            int numBits = 0;
+            for(uint64 x = a ^ b; x; x &= x - 1) ++numBits;
+            flipped += numBits / 64.0;
+            ++numTests;
+        }
+    flipped /= numTests;
+    if(flipped < 0.48 || flipped > 0.52)
+        std::cerr << "FAILED: StreamHash avalanche is " << flipped << '\n';
+    std::string key = "terrain/rock_01";
+    if(seedFrom(key) != seedFromString(key.c_str()) || seedFrom(key, 1) == seedFrom(key)
+        || seedFrom(key) != StreamHash().update(key.data(), key.size()).finish64())
+        std::cerr << "FAILED: seedFrom overloads are inconsistent.\n";
+    // Pointer and size of characters (the size must not become the salt)
+    const char* prefix = key.c_str();
+    if(seedFrom(prefix, 7) != seedFrom(key.substr(0, 7)) || seedFrom(prefix, 7, 1) != seedFrom(key.substr(0, 7), 1)
+        || seedFrom(prefix, key.size()) != seedFromString(prefix) || seedFromString(prefix, 7) == seedFromString(prefix))
+        std::cerr << "FAILED: seedFrom(const char*, size) is not the hash of the prefix.\n";
+}
+
+// First number of a scalar or multi-lane generator output.
+static uint32 firstLane(uint32 _x) { return _x; }
+template<typename Lanes>
+static uint32 firstLane(const Lanes& _x) { return _x[0]; }
+
+// Streams of a factory must be reproducible and distinct.
+template<typename RNG>
+static void testStreams(const char* _name)
+{
+    StreamFactory factory(98765);
+    RNG a = factory.create<RNG>(3);
+    RNG b = factory.create<RNG>(3);
+    RNG c = factory.create<RNG>(4);
+    RNG d = StreamFactory(98766).create<RNG>(3);
+    int numEqualC = 0, numEqualD = 0;
+    for(int i = 0; i < 64; ++i)
+    {
+        uint32 x = firstLane(a());
+        if(x != firstLane(b())) { std::cerr << "FAILED: " << _name << " stream is not reproducible.\n"; return; }
+        if(x == firstLane(c())) ++numEqualC;
+        if(x == firstLane(d())) ++numEqualD;
+    }
+    if(numEqualC > 1 || numEqualD > 1)
+        std::cerr << "FAILED: " << _name << " streams are not independent.\n";
+}
+
 static bool is_prime(uint64 p)
 {
     uint64 n = uint64(sqrt(p));
@@ -136,6 +379,102 @@ void test_generators()
     // Standard RNGs
     uint32 stdSeed = WangHash()(83642);
 
+    // Bulk generation
+    testFill(Xorshift32Rng(stdSeed), "Xorshift32Rng");
+    testFill(Rule30CARng(stdSeed), "Rule30CARng");
+    testFill(MwcRng(stdSeed), "MwcRng");
+    testFill(CmwcRng(stdSeed), "CmwcRng");
+    testFill(Lfsr113Rng(stdSeed), "Lfsr113Rng");
+    testFill(Well512Rng(stdSeed), "Well512Rng");
+    testFill(HaltonRng(5), "HaltonRng");
+    testFill(HaltonRevRng(5), "HaltonRevRng");
+    testFill(HaltonRng(32), "HaltonRng");
+    testFill(AdditiveRecurrenceRng(3), "AdditiveRecurrenceRng");
+    testFill(HammersleyRng(4, 1000), "HammersleyRng");
+    testFill(SobolRng(5), "SobolRng");
+    testFill(PhiloxRng(stdSeed), "PhiloxRng");
+    testFill(BufferedRng<Xorshift32Rng, 16>(Xorshift32Rng(stdSeed)), "BufferedRng<Xorshift32Rng>");
+    testFill(BufferedRng<Pcg64Rng, 7>(Pcg64Rng(stdSeed)), "BufferedRng<Pcg64Rng>");
+    testFill64(Xoshiro256Rng(stdSeed), "Xoshiro256Rng");
+    testFill64(Pcg64Rng(stdSeed), "Pcg64Rng");
+    testFill64(Splitmix64Rng(stdSeed), "Splitmix64Rng");
+
+    // Random access into Quasi-RNGs
+    testRandomAccess(HaltonRng(5), 5, 1, "HaltonRng");
+    testRandomAccess(HaltonRevRng(5), 5, 1, "HaltonRevRng");
+    testRandomAccess(AdditiveRecurrenceRng(3), 3, 0, "AdditiveRecurrenceRng");
+    testRandomAccess(HammersleyRng(4, 1000), 4, 0, "HammersleyRng");
+    testRandomAccess(HammersleyRng(33, 1000), 33, 0, "HammersleyRng");
+    testRandomAccess(SobolRng(5), 5, 1, "SobolRng");
+    testRandomAccess(SobolRng(64), 64, 1, "SobolRng");
+    testRadicalInverse(HaltonRng(32), false, "HaltonRng");
+    testRadicalInverse(HaltonRevRng(32), true, "HaltonRevRng");
+
+    // Buffered generators reproduce the wrapped sequence
+    BufferedRng<Well512Rng, 64> bufferedWell{Well512Rng(stdSeed)};
+    Well512Rng unbufferedWell(stdSeed);
+    for(int i = 0; i < 1000; ++i)
+        if(bufferedWell() != unbufferedWell()) { std::cerr << "FAILED: BufferedRng differs from the wrapped generator.\n"; break; }
+
+    // Stream factory
+    // (Quasi-RNGs are rejected at compile time.)
+    testStreams<Xorshift32Rng>("Xorshift32Rng");
+    testStreams<Rule30CARng>("Rule30CARng");
+    testStreams<MwcRng>("MwcRng");
+    testStreams<CmwcRng>("CmwcRng");
+    testStreams<Lfsr113Rng>("Lfsr113Rng");
+    testStreams<Well512Rng>("Well512Rng");
+    testStreams<Xoshiro256Rng>("Xoshiro256Rng");
+    testStreams<Pcg64Rng>("Pcg64Rng");
+    testStreams<Splitmix64Rng>("Splitmix64Rng");
+    testStreams<PhiloxRng>("PhiloxRng");
+    testStreams<Xorshift32x8Rng>("Xorshift32x8Rng");
+    testStreams<Lfsr113x8Rng>("Lfsr113x8Rng");
+    testStreams<Well512x4Rng>("Well512x4Rng");
+    testStreams<BufferedRng<Xoshiro256Rng, 64>>("BufferedRng<Xoshiro256Rng>");
+    Xoshiro256Rng jumped(StreamFactory(98765).seed(0));
+    jumped.jump(); jumped.jump();
+    if(jumped.next64() != StreamFactory(98765).create<Xoshiro256Rng>(2).next64())
+        std::cerr << "FAILED: Xoshiro256Rng streams are not created by jump-ahead.\n";
+    // Large ids must not take id jumps
+    Xoshiro256Rng farStream = StreamFactory(98765).create<Xoshiro256Rng>(~0ull);
+    Well512Rng farWell = StreamFactory(98765).create<Well512Rng>(1ull << 40);
+    if(farStream.next64() == jumped.next64() || farWell() == Well512Rng(StreamFactory(98765).seed(0))())
+        std::cerr << "FAILED: streams with large ids are not distinct.\n";
+    testJump(Lfsr113Rng(stdSeed), "Lfsr113Rng");
+    testJump(Well512Rng(stdSeed), "Well512Rng");
+    testJump(Xoshiro256Rng(stdSeed), "Xoshiro256Rng");
+    uint32 threadNumbers[2];
+    std::thread t0([&]() { setThreadStreamId(0); threadNumbers[0] = threadRng<PhiloxRng>()(); });
+    std::thread t1([&]() { setThreadStreamId(1); threadNumbers[1] = threadRng<PhiloxRng>()(); });
+    t0.join(); t1.join();
+    if(threadNumbers[0] != StreamFactory(0).create<PhiloxRng>(0)() || threadNumbers[1] != StreamFactory(0).create<PhiloxRng>(1)())
+        std::cerr << "FAILED: threadRng() does not use the stream of the thread.\n";
+
+    // Jump ahead
+    testDiscard(Xorshift32Rng(stdSeed), "Xorshift32Rng");
+    testDiscard(MwcRng(stdSeed), "MwcRng");
+    testDiscard(CmwcRng(stdSeed), "CmwcRng");
+    testDiscard(Lfsr113Rng(stdSeed), "Lfsr113Rng");
+    testDiscard(PhiloxRng(stdSeed), "PhiloxRng");
+    testDiscard(Pcg64Rng(stdSeed, 7), "Pcg64Rng");
+    testDiscard(Splitmix64Rng(stdSeed), "Splitmix64Rng");
+    testDiscard(Well512Rng(stdSeed), "Well512Rng");
+
+    // Multi-lane generators
+    std::vector<Xorshift32Rng> xorshiftLanes;
+    std::vector<Lfsr113Rng> lfsrLanes;
+    std::vector<Well512Rng> wellLanes;
+    for(uint32 i = 0; i < 8; ++i)
+    {
+        xorshiftLanes.push_back(Xorshift32Rng(WangHash()(stdSeed + i)));
+        lfsrLanes.push_back(Lfsr113Rng(stdSeed + 4 * i));
+        if(i < 4) wellLanes.push_back(Well512Rng(stdSeed + 16 * i));
+    }
+    testLanes(Xorshift32x8Rng(stdSeed), xorshiftLanes, "Xorshift32x8Rng");
+    testLanes(Lfsr113x8Rng(stdSeed), lfsrLanes, "Lfsr113x8Rng");
+    testLanes(Well512x4Rng(stdSeed), wellLanes, "Well512x4Rng");
+
     // Xorshift
     Xorshift32Rng xorshift32(stdSeed);
     testRNG(xorshift32, "Xorshift32");
@@ -158,6 +497,33 @@ void test_generators()
     Well512Rng well512(stdSeed);
     testRNG(well512, "Well512");
 
+    // 64 bit generators (known answers from the reference implementations)
+    Pcg64Rng pcg64(42, 54);
+    if(pcg64.next64() != 0x86b1da1d72062b68ull || pcg64.next64() != 0x1304aa46c9853d39ull || pcg64.next64() != 0xa3670e9e0dd50358ull)
+        std::cerr << "FAILED: Pcg64Rng known answer test.\n";
+    if(Splitmix64Rng(0).next64() != 0xe220a8397b1dcdafull)
+        std::cerr << "FAILED: Splitmix64Rng known answer test.\n";
+    Xoshiro256Rng xoshiro(stdSeed);
+    testRNG(xoshiro, "Xoshiro256**");
+    testRNG(pcg64, "Pcg64");
+
+    // Counter-based generators (known answers from the Random123 library)
+    if(Philox4x32Hash(0)(Vec<uint32,4>(0u, 0u, 0u, 0u)) != Vec<uint32,4>(0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u))
+        std::cerr << "FAILED: Philox4x32Hash known answer test 1.\n";
+    if(Philox4x32Hash(0x299f31d0a4093822ull)(Vec<uint32,4>(0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u))
+        != Vec<uint32,4>(0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u))
+        std::cerr << "FAILED: Philox4x32Hash known answer test 2.\n";
+    if(Threefry2x64Hash()(Vec<uint64,2>(0ull, 0ull)) != Vec<uint64,2>(0xc2b6e3a8c2c69865ull, 0x6f81ed42f350084dull))
+        std::cerr << "FAILED: Threefry2x64Hash known answer test 1.\n";
+    if(Threefry2x64Hash(0xa4093822299f31d0ull, 0x082efa98ec4e6c89ull)(Vec<uint64,2>(0x243f6a8885a308d3ull, 0x13198a2e03707344ull))
+        != Vec<uint64,2>(0x263c7d30bb0f0af1ull, 0x56be8361d3311526ull))
+        std::cerr << "FAILED: Threefry2x64Hash known answer test 2.\n";
+    if(sample(stdSeed, 12345, 6) != sample(stdSeed, 12345, 6) || sample(stdSeed, 12345, 6) == sample(stdSeed, 12345, 7)
+        || sample(stdSeed, 12345, 6) == sample(stdSeed, 12346, 6) || sample(stdSeed, 12345, 6) == sample(stdSeed + 1, 12345, 6))
+        std::cerr << "FAILED: sample(seed, index, dimension) is not a function of its arguments.\n";
+    PhiloxRng philox(stdSeed);
+    testRNG(philox, "Philox");
+
     // Halton sequences
     HaltonRng halton;
     if(uniformEx(halton) != 0.5f)    std::cerr << "FAILED: 1. number of Halton sequence wrong.\n";
@@ -173,6 +539,25 @@ void test_generators()
     const HaltonRng haltonStat(D);
     testRNG(haltonStat, "Halton");
 
+    // Sobol sequence
+    SobolRng sobol2(2);
+    if(sobol2() != 0x80000000u || sobol2() != 0x80000000u)    std::cerr << "FAILED: 1. point of Sobol sequence wrong.\n";
+    if(sobol2() != 0xc0000000u || sobol2() != 0x40000000u)    std::cerr << "FAILED: 2. point of Sobol sequence wrong.\n";
+    if(sobol2() != 0x40000000u || sobol2() != 0xc0000000u)    std::cerr << "FAILED: 3. point of Sobol sequence wrong.\n";
+    // The first 2^k points are stratified in each dimension
+    SobolRng sobol64(64);
+    std::vector<uint32> sobolBlock(64 * 1024);
+    sobol64.generateBlock(0, 1024, sobolBlock.data());
+    for(uint32 d = 0; d < 64; ++d)
+    {
+        std::vector<bool> strata(1024, false);
+        for(uint32 i = 0; i < 1024; ++i) strata[sobolBlock[d * 1024 + i] >> 22] = true;
+        if(std::find(strata.begin(), strata.end(), false) != strata.end())
+            std::cerr << "FAILED: Sobol dimension " << d << " is not stratified.\n";
+    }
+    const SobolRng sobolStat(D);
+    testRNG(sobolStat, "Sobol");
+
     // Additive recurrence
     const AdditiveRecurrenceRng additiveStat(D);
     testRNG(additiveStat, "Additive Recurrence");
@@ -194,6 +579,16 @@ void test_generators()
     std::cout << "    Gap variance: " << gapVariance(samples.data(), 100000) << '\n';
 
 
+    // Batch hashing
+    testBatchHash(KnuthHash(), stdSeed, "KnuthHash");
+    testBatchHash(WangHash(), stdSeed, "WangHash");
+    testBatchHash(JenkinsHash(), stdSeed, "JenkinsHash");
+    testBatchHash(Murmur32Hash(), stdSeed, "Murmur32Hash");
+    testBatchHash(ProspectorHash(), stdSeed, "ProspectorHash");
+    testBatchHash(ProspectorXHash(), stdSeed, "ProspectorXHash");
+    testBatchHash(Splitmix64Hash(), uint64(stdSeed * 0x100000001ull), "Splitmix64Hash");
+    testStreamHash();
+
     // *** Avalanche Test ***
     std::cout << "Avalanche for KnuthHash is: " << avalanche(KnuthHash(), 128) << ", " << avalanche(KnuthHash(), 1024) << ", " << avalanche(KnuthHash(), 16384) << '\n';
     std::cout << "Avalanche for WangHash is: " << avalanche(WangHash(), 128) << ", " << avalanche(WangHash(), 1024) << ", " << avalanche(WangHash(), 16384) << '\n';
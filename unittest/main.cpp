@@ -5,6 +5,7 @@ void test_generators();
 void test_distributions();
 void test_sphsampling();
 void test_fields();
+void benchmark_generators();
 
 // Method to store a squared image into .pfm format.
 // This is used in the visualization of some test results
@@ -32,8 +33,9 @@ bool writePFM(const char* _name, int _size, const float* _data)
 int main()
 {
     test_distributions();
- //   test_fields();
+    test_fields();
     test_generators();
   //  test_sphsampling();
+  //  benchmark_generators();
     return 0;
 }
\ No newline at end of file